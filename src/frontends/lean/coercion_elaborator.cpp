@@ -47,7 +47,7 @@ list<expr> get_coercions_from_to(type_checker & from_tc, type_checker & to_tc,
             // We create a new list: (fun (f : D -> A) (x : D), c (f x))
             expr f = mk_local(mk_fresh_name(), "f", whnf_from_type, binder_info());
             expr fx = mk_app(f, x);
-            return map(coe, [&](expr const & c) { return Fun(f, Fun(x, mk_app(c, fx))); });
+            return map(coe, [&](expr const & c) { return Fun(f, Fun(x, mk_coercion_app(c, fx))); });
         } else {
             return list<expr>();
         }
@@ -76,7 +76,7 @@ optional<constraints> coercion_elaborator::next() {
     } else if (m_coercions) {
         expr c      = head(m_coercions);
         m_coercions = tail(m_coercions);
-        m_info.save_coercion_info(m_arg, mk_app(c, m_arg));
+        m_info.save_coercion_info(m_arg, mk_coercion_app(c, m_arg));
     }
     auto r = head(m_choices);
     m_choices = tail(m_choices);
@@ -148,8 +148,8 @@ constraint mk_coercion_cnstr(type_checker & from_tc, type_checker & to_tc, coerc
                 --i;
                 expr coe = alts[i];
                 if (!locals.empty())
-                    coe = Fun(fn_a, Fun(locals, mk_app(coe, mk_app(fn_a, locals))));
-                expr new_a = copy_tag(a, mk_app(coe, a));
+                    coe = Fun(fn_a, Fun(locals, mk_coercion_app(coe, mk_app(fn_a, locals))));
+                expr new_a = copy_tag(a, mk_coercion_app(coe, a));
                 coes.push_back(coe);
                 constraint_seq csi = cs + mk_eq_cnstr(meta, new_a, new_a_type_jst);
                 choices.push_back(csi.to_list());
@@ -165,13 +165,13 @@ constraint mk_coercion_cnstr(type_checker & from_tc, type_checker & to_tc, coerc
                 cs += mk_eq_cnstr(meta, new_a, new_a_type_jst);
                 return lazy_list<constraints>(cs.to_list());
             } else if (is_nil(tail(coes))) {
-                expr new_a = copy_tag(a, mk_app(head(coes), a));
+                expr new_a = copy_tag(a, mk_coercion_app(head(coes), a));
                 infom.save_coercion_info(a, new_a);
                 cs += mk_eq_cnstr(meta, new_a, new_a_type_jst);
                 return lazy_list<constraints>(cs.to_list());
             } else {
                 list<constraints> choices = map2<constraints>(coes, [&](expr const & coe) {
-                        expr new_a   = copy_tag(a, mk_app(coe, a));
+                        expr new_a   = copy_tag(a, mk_coercion_app(coe, a));
                         constraint c = mk_eq_cnstr(meta, new_a, new_a_type_jst);
                         return (cs + c).to_list();
                     });
@@ -9,6 +9,7 @@ Author: Leonardo de Moura
 #include "util/fresh_name.h"
 #include "util/sstream.h"
 #include "util/timeit.h"
+#include "util/stats.h"
 #include "kernel/type_checker.h"
 #include "kernel/abstract.h"
 #include "kernel/replace_fn.h"
@@ -22,6 +23,7 @@ Author: Leonardo de Moura
 #include "library/locals.h"
 #include "library/explicit.h"
 #include "library/abbreviation.h"
+#include "library/compress_proof.h"
 #include "library/definitional/equations.h"
 #include "library/error_handling.h"
 #include "frontends/lean/parser.h"
@@ -873,6 +875,15 @@ class definition_cmd_fn {
         ::lean::display_pos(out, m_p.get_stream_name().c_str(), m_pos.first, m_pos.second);
     }
 
+    /** \brief Abbreviate repeated subterms of the proof \c v if the option compress_proofs is set. */
+    expr compress(expr const & v) {
+        options o = m_p.get_options();
+        if (get_compress_proofs(o))
+            return compress_proof(m_env, v, o);
+        else
+            return v;
+    }
+
     certified_declaration check(declaration const & d) {
         if (m_p.profiling()) {
             std::ostringstream msg;
@@ -1080,10 +1091,11 @@ class definition_cmd_fn {
                 m_env = module::add(m_env, check(mk_definition(m_env, m_real_aux_names[i], new_ls,
                                                                m_aux_types[i], aux_values[i])));
         } else {
+            m_value = compress(m_value);
             m_env = module::add(m_env, check(mk_theorem(m_env, m_real_name, new_ls, m_type, m_value)));
             for (unsigned i = 0; i < aux_values.size(); i++)
                 m_env = module::add(m_env, check(mk_theorem(m_env, m_real_aux_names[i], new_ls,
-                                                            m_aux_types[i], aux_values[i])));
+                                                            m_aux_types[i], compress(aux_values[i]))));
         }
     }
 
@@ -1112,7 +1124,7 @@ class definition_cmd_fn {
                 } else {
                     std::tie(m_type, m_value, new_ls) = elaborate_definition(type_as_is, m_value);
                     m_type  = postprocess(m_env, m_type);
-                    m_value = postprocess(m_env, m_value);
+                    m_value = compress(postprocess(m_env, m_value));
                     new_ls = append(m_ls, new_ls);
                     auto cd = check(mk_theorem(m_env, m_real_name, new_ls, m_type, m_value));
                     if (m_kind == Theorem) {
@@ -1176,6 +1188,7 @@ public:
     environment operator()() {
         try {
             parse();
+            scope_stats_group scope(m_real_name, m_p.collecting_stats());
             process_locals();
             elaborate();
             register_decl();
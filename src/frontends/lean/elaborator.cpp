@@ -122,11 +122,67 @@ type_checker_ptr mk_coercion_to_type_checker(environment const & env) {
         });
 }
 
+/** \brief Return \c type if it is a sort, or the head of \c type if it is an inductive datatype.
+    These heads are rigid: two types with different rigid heads are not definitionally equal. */
+static optional<expr> get_rigid_head(environment const & env, expr const & type) {
+    if (is_sort(type))
+        return some_expr(type);
+    expr const & fn = get_app_fn(type);
+    if (is_constant(fn) && inductive::is_inductive_decl(env, const_name(fn)))
+        return some_expr(fn);
+    return none_expr();
+}
+
+/** \brief Cheap test used to prune the alternatives of a choice expression.
+    Return false if the alternative \c c (i.e., <tt>f a_1 ... a_k</tt> where \c f is a constant)
+    cannot have type \c type. The test only uses the declared type of \c f: we compute its result
+    type after consuming \c k explicit arguments, and compare its rigid head with the one of \c type.
+    It is conservative: heads that may unfold or be coerced are never used to reject an alternative. */
+static bool is_viable_alternative(environment const & env, expr const & c, expr const & type) {
+    optional<expr> expected = get_rigid_head(env, type);
+    if (!expected)
+        return true;
+    expr const & fn = get_app_fn(c);
+    if (!is_constant(fn))
+        return true;
+    optional<declaration> d = env.find(const_name(fn));
+    if (!d)
+        return true;
+    unsigned nargs = get_app_num_args(c);
+    unsigned i     = 0;
+    expr r         = d->get_type();
+    while (is_pi(r)) {
+        binder_info const & bi = binding_info(r);
+        if (i < nargs) {
+            if (is_explicit(bi))
+                i++;
+        } else if (!bi.is_implicit() && !bi.is_inst_implicit()) {
+            break;
+        }
+        r = binding_body(r);
+    }
+    optional<expr> result = get_rigid_head(env, r);
+    if (!result)
+        return true;
+    if (i < nargs) {
+        // too many arguments, the result must be coerced to a function
+        return !is_sort(*result) && has_coercions_from(env, const_name(*result));
+    } else if (is_sort(*result)) {
+        // c is a type
+        return is_sort(*expected);
+    } else {
+        return (!is_sort(*expected) && const_name(*expected) == const_name(*result)) ||
+            has_coercions_from(env, const_name(*result));
+    }
+}
+
 /** \brief 'Choice' expressions <tt>(choice e_1 ... e_n)</tt> are mapped into a metavariable \c ?m
     and a choice constraints <tt>(?m in fn)</tt> where \c fn is a choice function.
     The choice function produces a stream of alternatives. In this case, it produces a stream of
     size \c n, one alternative for each \c e_i.
     This is a helper class for implementing this choice functions.
+    Alternatives that cannot have the expected type (see \c is_viable_alternative) are skipped
+    before they are elaborated.
 */
 struct elaborator::choice_expr_elaborator : public choice_iterator {
     elaborator &  m_elab;
@@ -149,6 +205,8 @@ struct elaborator::choice_expr_elaborator : public choice_iterator {
             expr const & c = get_choice(m_choice, m_idx);
             expr const & f = get_app_fn(c);
             m_elab.save_identifier_info(f);
+            if (!is_viable_alternative(m_elab.env(), c, m_type))
+                continue;
             try {
                 flet<old_local_context> set1(m_elab.m_context,         m_context);
                 flet<bool>              set2(m_elab.m_in_equation_lhs, m_in_equation_lhs);
@@ -383,7 +441,6 @@ expr elaborator::visit_expecting_type_of(expr const & e, expr const & t, constra
 
 expr elaborator::visit_choice(expr const & e, optional<expr> const & t, constraint_seq & cs) {
     lean_assert(is_choice(e));
-    // Possible optimization: try to lookahead and discard some of the alternatives.
     expr m = m_context.mk_meta(t, e.get_tag());
     register_meta(m);
     old_local_context ctx      = m_context;
@@ -473,11 +530,11 @@ expr elaborator::add_implict_args(expr e, constraint_seq & cs) {
     }
 }
 
-static expr mk_coercion_app(expr const & coe, expr const & a) {
+static expr mk_tagged_coercion_app(expr const & coe, expr const & a) {
     if (is_inaccessible(a))
-        return copy_tag(a, mk_inaccessible(mk_app(coe, get_annotation_arg(a), a.get_tag())));
+        return copy_tag(a, mk_inaccessible(copy_tag(a, mk_coercion_app(coe, get_annotation_arg(a)))));
     else
-        return mk_app(coe, a, a.get_tag());
+        return copy_tag(a, mk_coercion_app(coe, a));
 }
 
 /** \brief Make sure \c f is really a function, if it is not, try to apply coercions.
@@ -508,7 +565,7 @@ pair<expr, expr> elaborator::ensure_fun(expr f, constraint_seq & cs) {
                 throw_kernel_exception(env(), f, [=](formatter const & fmt) { return pp_function_expected(fmt, f, f_type); });
             } else if (is_nil(tail(coes))) {
                 expr old_f = f;
-                f = mk_coercion_app(head(coes), f);
+                f = mk_tagged_coercion_app(head(coes), f);
                 f = add_implict_args(f, cs);
                 f_type = infer_type(f, cs);
                 save_coercion_info(old_f, f);
@@ -521,7 +578,7 @@ pair<expr, expr> elaborator::ensure_fun(expr f, constraint_seq & cs) {
                 auto choice_fn = [=](expr const & meta, expr const &, substitution const &) {
                     flet<old_local_context> save1(m_context,      ctx);
                     list<constraints> choices = map2<constraints>(coes, [&](expr const & coe) {
-                            expr new_f      = mk_coercion_app(coe, f);
+                            expr new_f      = mk_tagged_coercion_app(coe, f);
                             constraint_seq cs;
                             new_f = add_implict_args(new_f, cs);
                             cs += mk_eq_cnstr(meta, new_f, j);
@@ -595,13 +652,13 @@ pair<expr, constraint_seq> elaborator::apply_coercion(expr const & a, expr a_typ
         erase_coercion_info(a);
         return to_ecs(a);
     } else if (is_nil(tail(coes))) {
-        expr r = mk_coercion_app(head(coes), a);
+        expr r = mk_tagged_coercion_app(head(coes), a);
         save_coercion_info(a, r);
         return to_ecs(r);
     } else {
         optional<expr> r;
         for (expr const & coe : coes) {
-            expr new_r = mk_coercion_app(coe, a);
+            expr new_r = mk_tagged_coercion_app(coe, a);
             expr new_r_type = infer_type(new_r).first;
             try {
                 if (m_tc->is_def_eq(new_r_type, d_type).first) {
@@ -874,7 +931,7 @@ expr elaborator::ensure_type(expr const & e, constraint_seq & cs) {
         throw_kernel_exception(env(), e, [=](formatter const & fmt) { return pp_type_expected(fmt, e); });
     } else {
         // Remark: we ignore other coercions to sort
-        expr r = mk_coercion_app(head(coes), e);
+        expr r = mk_tagged_coercion_app(head(coes), e);
         save_coercion_info(e, r);
         return r;
     }
@@ -138,11 +138,13 @@ parser::parser(environment const & env, io_state const & ios,
     m_scanner(strm, strm_name, s ? s->m_line : 1),
     m_base_dir(base_dir),
     m_theorem_queue(*this, num_threads > 1 ? num_threads - 1 : 0),
-    m_snapshot_vector(sv), m_info_manager(im), m_cache(nullptr), m_index(nullptr) {
+    m_snapshot_vector(sv), m_info_manager(im), m_cache(nullptr), m_index(nullptr),
+    m_id_resolution_env(env.get_id()) {
     m_local_decls_size_at_beg_cmd = 0;
     m_in_backtick = false;
     m_ignore_noncomputable = false;
     m_profile     = ios.get_options().get_bool("profile", false);
+    m_stats       = ios.get_options().get_bool("stats", false);
     init_stop_at(ios.get_options());
     if (num_threads > 1 && m_profile)
         throw exception("option --profile cannot be used when theorems are compiled in parallel");
@@ -1467,6 +1469,36 @@ expr parser::mk_placeholder_local(name const & id, pos_info const & p) {
     return save_pos(local, p);
 }
 
+parser::id_resolution const & parser::resolve_id(name const & id) {
+    if (!m_id_resolution_env.is_eqp(m_env.get_id())) {
+        m_id_resolution_cache.clear();
+        m_id_resolution_env = m_env.get_id();
+    }
+    auto it = m_id_resolution_cache.find(id);
+    if (it != m_id_resolution_cache.end())
+        return it->second;
+    id_resolution & r = m_id_resolution_cache[id];
+    for (name const & ns : get_namespaces(m_env)) {
+        if (ns.is_anonymous())
+            continue;
+        name new_id = ns + id;
+        if (m_env.find(new_id) && (!id.is_atomic() || !is_protected(m_env, new_id))) {
+            r.m_ns_id = new_id;
+            return r;
+        }
+    }
+    if (!id.is_atomic()) {
+        name new_id = remove_root_prefix(id);
+        if (m_env.find(new_id)) {
+            r.m_root_id = new_id;
+            return r;
+        }
+    }
+    r.m_global  = static_cast<bool>(m_env.find(id));
+    r.m_aliases = get_expr_aliases(m_env, id);
+    return r;
+}
+
 expr parser::id_to_expr(name const & id, pos_info const & p) {
     buffer<level> lvl_buffer;
     levels ls;
@@ -1492,37 +1524,33 @@ expr parser::id_to_expr(name const & id, pos_info const & p) {
         return r;
     }
 
-    for (name const & ns : get_namespaces(m_env)) {
-        auto new_id = ns + id;
-        if (!ns.is_anonymous() && m_env.find(new_id) &&
-            (!id.is_atomic() || !is_protected(m_env, new_id))) {
-            if (m_undef_id_behavior == undef_id_behavior::AssumeLocalAndAlsoDefinedNonConstructors &&
-                    id.is_atomic() && !inductive::is_intro_rule(m_env, new_id)) {
-                return mk_placeholder_local(id, p);
-            }
-            auto r = save_pos(mk_constant(new_id, ls), p);
-            save_type_info(r);
-            add_ref_index(new_id, p);
-            save_identifier_info(p, new_id);
-            return r;
+    id_resolution const & res = resolve_id(id);
+
+    if (res.m_ns_id) {
+        name const & new_id = *res.m_ns_id;
+        if (m_undef_id_behavior == undef_id_behavior::AssumeLocalAndAlsoDefinedNonConstructors &&
+                id.is_atomic() && !inductive::is_intro_rule(m_env, new_id)) {
+            return mk_placeholder_local(id, p);
         }
+        auto r = save_pos(mk_constant(new_id, ls), p);
+        save_type_info(r);
+        add_ref_index(new_id, p);
+        save_identifier_info(p, new_id);
+        return r;
     }
 
-    if (!id.is_atomic()) {
-        name new_id = id;
-        new_id = remove_root_prefix(new_id);
-        if (m_env.find(new_id)) {
-            auto r = save_pos(mk_constant(new_id, ls), p);
-            save_type_info(r);
-            add_ref_index(new_id, p);
-            save_identifier_info(p, new_id);
-            return r;
-        }
+    if (res.m_root_id) {
+        name const & new_id = *res.m_root_id;
+        auto r = save_pos(mk_constant(new_id, ls), p);
+        save_type_info(r);
+        add_ref_index(new_id, p);
+        save_identifier_info(p, new_id);
+        return r;
     }
 
     optional<expr> r;
     // globals
-    if (m_env.find(id)) {
+    if (res.m_global) {
         if (m_undef_id_behavior == undef_id_behavior::AssumeLocalAndAlsoDefinedNonConstructors && id.is_atomic()) {
             bool has_constructor = false;
             for (auto & c : to_constants(id, "", p)) {
@@ -1535,7 +1563,7 @@ expr parser::id_to_expr(name const & id, pos_info const & p) {
         r = save_pos(mk_constant(id, ls), p);
     }
     // aliases
-    auto as = get_expr_aliases(m_env, id);
+    list<name> as = res.m_aliases;
     if (!is_nil(as)) {
         buffer<expr> new_as;
         if (r)
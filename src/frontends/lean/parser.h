@@ -8,6 +8,7 @@ Author: Leonardo de Moura
 #include <string>
 #include <utility>
 #include <vector>
+#include <unordered_map>
 #include "util/flet.h"
 #include "util/name_map.h"
 #include "util/exception.h"
@@ -136,8 +137,23 @@ class parser {
 
     buffer<expr>           m_undef_ids;
 
+    // Environment dependent part of the identifier resolution performed by id_to_expr.
+    // The cache is reset whenever m_env changes (e.g., new declarations, open/namespace commands).
+    struct id_resolution {
+        optional<name> m_ns_id;   // declaration found by prefixing the identifier with an open namespace
+        optional<name> m_root_id; // declaration found after removing the _root_ prefix
+        bool           m_global;  // true if the identifier is a declaration
+        list<name>     m_aliases;
+        id_resolution():m_global(false) {}
+    };
+    typedef std::unordered_map<name, id_resolution, name_hash, name_eq> id_resolution_cache;
+    environment_id         m_id_resolution_env;
+    id_resolution_cache    m_id_resolution_cache;
+
     // profiling
     bool                   m_profile;
+    // collect statistics for each declaration (see util/stats.h)
+    bool                   m_stats;
 
     // auxiliary field used to record the size of m_local_decls before a command is executed.
     unsigned               m_local_decls_size_at_beg_cmd;
@@ -524,6 +540,8 @@ public:
 
     /** return true iff profiling is enabled */
     bool profiling() const { return m_profile; }
+    /** return true iff statistics should be collected for each declaration */
+    bool collecting_stats() const { return m_stats; }
 
     /** parse all commands in the input stream */
     bool operator()() { return parse_commands(); }
@@ -535,6 +553,7 @@ public:
     };
 
     expr mk_placeholder_local(const name &id, const pos_info &p);
+    id_resolution const & resolve_id(name const & id);
 };
 
 bool parse_commands(environment & env, io_state & ios, std::istream & in, char const * strm_name, optional<std::string> const & base_dir,
@@ -836,6 +836,12 @@ auto pretty_fn::pp_macro(expr const & e) -> result {
 auto pretty_fn::pp_let(expr e) -> result {
     buffer<pair<name, expr>> decls;
     while (true) {
+        if (is_let(e)) {
+            name n = pick_unused_name(let_body(e), let_name(e));
+            decls.emplace_back(n, let_value(e));
+            e = instantiate(let_body(e), mk_constant(n));
+            continue;
+        }
         if (!is_let_macro(e))
             break;
         name n   = get_let_var_name(e);
@@ -1289,9 +1295,7 @@ auto pretty_fn::pp(expr const & e, bool ignore_hide) -> result {
     case expr_kind::Lambda:    return pp_lambda(e);
     case expr_kind::Pi:        return pp_pi(e);
     case expr_kind::Macro:     return pp_macro(e);
-    case expr_kind::Let:
-        // NOT IMPLEMENTED YET
-        lean_unreachable();
+    case expr_kind::Let:       return pp_let(e);
     }
     lean_unreachable(); // LCOV_EXCL_LINE
 }
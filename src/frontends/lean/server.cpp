@@ -13,6 +13,7 @@ Author: Leonardo de Moura
 #include "util/exception.h"
 #include "util/sexpr/option_declarations.h"
 #include "util/bitap_fuzzy_search.h"
+#include "util/stats.h"
 #include "kernel/instantiate.h"
 #include "library/aliases.h"
 #include "library/type_util.h"
@@ -49,7 +50,8 @@ unsigned get_auto_completion_max_results(options const & o) {
     return o.get_unsigned(*g_auto_completion_max_results, LEAN_DEFAULT_AUTO_COMPLETION_MAX_RESULTS);
 }
 
-server::file::file(std::istream & in, std::string const & fname):m_fname(fname) {
+server::file::file(std::istream & in, std::string const & fname):
+    m_fname(fname), m_status(check_status::Idle), m_check_from(0) {
     for (std::string line; std::getline(in, line);) {
         m_lines.push_back(line);
     }
@@ -160,6 +162,52 @@ unsigned server::file::copy_to(std::string & block, unsigned starting_from) {
     return num_lines;
 }
 
+unsigned server::file::check(unsigned line_num, snapshot const & empty_snapshot, io_state const & ios,
+                             optional<std::string> const & base_dir, definition_cache & cache) {
+    // extract block of code and snapshot
+    std::string block;
+    unsigned    num_lines;
+    snapshot    s;
+    {
+        lock_guard<mutex> lk(m_lines_mutex);
+        unsigned i = find(line_num);
+        m_snapshots.resize(i);
+        s = i == 0 ? empty_snapshot : m_snapshots[i-1];
+        if (direct_imports_have_changed(s.m_env))
+            s = empty_snapshot;
+        lean_assert(s.m_line > 0);
+        m_info.start_from(s.m_line);
+        m_info.save_environment_options(s.m_line, 0, s.m_env, s.m_options);
+        num_lines = copy_to(block, s.m_line - 1);
+    }
+    check_interrupted();
+    // parse block of code with respect to snapshot
+    try {
+        std::istringstream strm(block);
+        #if defined(LEAN_SERVER_DIAGNOSTIC)
+        std::shared_ptr<output_channel> out1(new stderr_channel());
+        std::shared_ptr<output_channel> out2(new stderr_channel());
+        #else
+        std::shared_ptr<output_channel> out1(new string_output_channel());
+        std::shared_ptr<output_channel> out2(new string_output_channel());
+        #endif
+        io_state tmp_ios(ios, out1, out2);
+        tmp_ios.set_options(join(s.m_options, ios.get_options()));
+        bool use_exceptions  = false;
+        unsigned num_threads = 1;
+        parser p(s.m_env, tmp_ios, strm, m_fname.c_str(), base_dir,
+                 use_exceptions, num_threads,
+                 &s, &m_snapshots, &m_info);
+        p.set_cache(&cache);
+        p();
+    } catch (interrupted &) {
+        throw;
+    } catch (throwable & ex) {
+        DIAG(std::cerr << "worker exception: " << ex.what() << "\n";)
+    }
+    return num_lines;
+}
+
 server::worker::worker(environment const & env, io_state const & ios, definition_cache & cache, optional<std::string> const & base_dir):
     m_empty_snapshot(env, ios.get_options()),
     m_cache(cache),
@@ -180,68 +228,33 @@ server::worker::worker(environment const & env, io_state const & ios, definition
                         todo_file    = m_todo_file;
                         todo_line_num = m_todo_line_num;
                         todo_options = m_todo_options;
+                        m_active_file = todo_file;
                         break;
                     } else {
                         m_todo_cv.wait(lk);
                     }
                 }
-                // extract block of code and snapshot from todo_file
                 reset_interrupt();
                 bool worker_interrupted = false;
                 if (m_terminate)
                     break;
                 DIAG(std::cerr << "processing '" << todo_file->get_fname() << "'\n";)
-                std::string block;
-                unsigned    num_lines;
-                snapshot    s;
-                {
-                    lean_assert(todo_file);
-                    lock_guard<mutex> lk(todo_file->m_lines_mutex);
-                    unsigned i = todo_file->find(todo_line_num);
-                    todo_file->m_snapshots.resize(i);
-                    s = i == 0 ? m_empty_snapshot : todo_file->m_snapshots[i-1];
-                    if (direct_imports_have_changed(s.m_env))
-                        s = m_empty_snapshot;
-                    lean_assert(s.m_line > 0);
-                    todo_file->m_info.start_from(s.m_line);
-                    todo_file->m_info.save_environment_options(s.m_line, 0, s.m_env, s.m_options);
-                    num_lines = todo_file->copy_to(block, s.m_line - 1);
-                }
-                if (m_terminate)
-                    break;
-                // parse block of code with respect to snapshot
+                unsigned num_lines = 0;
                 try {
-                    std::istringstream strm(block);
-                    #if defined(LEAN_SERVER_DIAGNOSTIC)
-                    std::shared_ptr<output_channel> out1(new stderr_channel());
-                    std::shared_ptr<output_channel> out2(new stderr_channel());
-                    #else
-                    std::shared_ptr<output_channel> out1(new string_output_channel());
-                    std::shared_ptr<output_channel> out2(new string_output_channel());
-                    #endif
-                    io_state tmp_ios(_ios, out1, out2);
-                    tmp_ios.set_options(join(s.m_options, _ios.get_options()));
-                    bool use_exceptions  = false;
-                    unsigned num_threads = 1;
-                    parser p(s.m_env, tmp_ios, strm, todo_file->m_fname.c_str(), m_base_dir,
-                        use_exceptions, num_threads,
-                        &s, &todo_file->m_snapshots, &todo_file->m_info);
-                    p.set_cache(&m_cache);
-                    p();
+                    num_lines = todo_file->check(todo_line_num, m_empty_snapshot, _ios, m_base_dir, m_cache);
                 } catch (interrupted &) {
                     worker_interrupted = true;
-                } catch (throwable & ex) {
-                    DIAG(std::cerr << "worker exception: " << ex.what() << "\n";)
                 }
+                unique_lock<mutex> lk(m_todo_mutex);
+                m_active_file = nullptr;
                 if (!m_terminate && !worker_interrupted) {
                     DIAG(std::cerr << "finished '" << todo_file->get_fname() << "'\n";)
-                    unique_lock<mutex> lk(m_todo_mutex);
                     if (m_todo_file == todo_file && m_last_file == todo_file && m_todo_line_num == todo_line_num) {
                         m_todo_line_num = num_lines + 1;
                         m_todo_file    = nullptr;
-                        m_todo_cv.notify_all();
                     }
                 }
+                m_todo_cv.notify_all();
             }
         }) {}
 
@@ -273,6 +286,12 @@ bool server::worker::wait(optional<unsigned> const & ms) {
     }
 }
 
+void server::worker::wait_inactive(file_ptr const & f) {
+    unique_lock<mutex> lk(m_todo_mutex);
+    while (m_active_file == f)
+        m_todo_cv.wait(lk);
+}
+
 void server::worker::set_todo(file_ptr const & f, unsigned line_num, options const & o) {
     lock_guard<mutex> lk(m_todo_mutex);
     if (m_last_file != f || line_num < m_todo_line_num)
@@ -283,6 +302,125 @@ void server::worker::set_todo(file_ptr const & f, unsigned line_num, options con
     m_todo_cv.notify_all();
 }
 
+server::checker::checker(environment const & env, io_state const & ios, definition_cache & cache,
+                         optional<std::string> const & base_dir, unsigned num_threads):
+    m_empty_snapshot(env, ios.get_options()),
+    m_cache(cache),
+    m_base_dir(base_dir),
+    m_terminate(false) {
+    if (num_threads == 0)
+        num_threads = 1;
+    m_active.resize(num_threads);
+    for (unsigned i = 0; i < num_threads; i++) {
+        m_threads.push_back(std::unique_ptr<interruptible_thread>(new interruptible_thread([=]() {
+                        io_state _ios(ios);
+                        while (!m_terminate) {
+                            file_ptr f;
+                            unsigned from;
+                            {
+                                unique_lock<mutex> lk(m_mutex);
+                                while (!m_terminate && m_queue.empty())
+                                    m_cv.wait(lk);
+                                if (m_terminate)
+                                    break;
+                                f = m_queue.back();
+                                m_queue.pop_back();
+                                f->m_status = check_status::Checking;
+                                m_active[i] = f;
+                                from = f->m_check_from;
+                                // next time, we resume from the last snapshot
+                                f->m_check_from = std::numeric_limits<unsigned>::max();
+                            }
+                            // clear interruption requests for files that have already been processed
+                            reset_interrupt();
+                            bool interrupted_flag = false;
+                            DIAG(std::cerr << "checking '" << f->get_fname() << "'\n";)
+                            try {
+                                f->check(from, m_empty_snapshot, _ios, m_base_dir, m_cache);
+                            } catch (interrupted &) {
+                                interrupted_flag = true;
+                            }
+                            lock_guard<mutex> lk(m_mutex);
+                            m_active[i] = nullptr;
+                            if (!m_terminate) {
+                                if (f->m_status == check_status::Queued ||
+                                    (interrupted_flag && f->m_status == check_status::Checking)) {
+                                    // restart was requested, or the interruption was not meant for this file
+                                    f->m_status = check_status::Queued;
+                                    m_queue.push_back(f);
+                                } else if (!interrupted_flag) {
+                                    f->m_status = check_status::Done;
+                                }
+                            }
+                            m_cv.notify_all();
+                        }
+                    })));
+    }
+}
+
+server::checker::~checker() {
+    {
+        lock_guard<mutex> lk(m_mutex);
+        m_terminate = true;
+        m_cv.notify_all();
+    }
+    for (auto & th : m_threads)
+        th->request_interrupt();
+    for (auto & th : m_threads)
+        th->join();
+}
+
+void server::checker::remove_from_queue(file_ptr const & f) {
+    m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), f), m_queue.end());
+}
+
+void server::checker::enqueue(file_ptr const & f, bool force) {
+    lock_guard<mutex> lk(m_mutex);
+    if (!force && f->m_status != check_status::Idle)
+        return;
+    if (force)
+        f->m_check_from = 0;
+    if (f->m_status == check_status::Checking) {
+        // restart
+        f->m_status = check_status::Queued;
+        for (unsigned i = 0; i < m_active.size(); i++) {
+            if (m_active[i] == f)
+                m_threads[i]->request_interrupt();
+        }
+        return;
+    }
+    remove_from_queue(f);
+    f->m_status = check_status::Queued;
+    m_queue.push_back(f);
+    m_cv.notify_one();
+}
+
+bool server::checker::cancel(file_ptr const & f) {
+    unique_lock<mutex> lk(m_mutex);
+    remove_from_queue(f);
+    while (true) {
+        bool active = false;
+        for (unsigned i = 0; i < m_active.size(); i++) {
+            if (m_active[i] == f) {
+                active = true;
+                f->m_status = check_status::Idle;
+                m_threads[i]->request_interrupt();
+            }
+        }
+        if (!active)
+            break;
+        m_cv.wait(lk);
+    }
+    bool done   = f->m_status == check_status::Done;
+    f->m_status = check_status::Idle;
+    return done;
+}
+
+server::check_status server::checker::get_status(file_ptr const & f) {
+    lock_guard<mutex> lk(m_mutex);
+    return f->m_status;
+}
+
 server::server(environment const & env, io_state const & ios, optional<std::string> const & base_dir,
                unsigned num_threads):
     m_env(env), m_ios(ios), m_out(ios.get_regular_channel().get_stream()),
@@ -292,9 +430,13 @@ server::server(environment const & env, io_state const & ios, optional<std::stri
 #if !defined(LEAN_MULTI_THREAD)
     lean_unreachable();
 #endif
+    // files with the same imports share the imported environment
+    set_import_cache(&m_import_cache);
 }
 
 server::~server() {
+    m_checker.reset();
+    set_import_cache(nullptr);
 }
 
 void server::interrupt_worker() {
@@ -319,6 +461,9 @@ static std::string * g_show = nullptr;
 static std::string * g_valid = nullptr;
 static std::string * g_sleep = nullptr;
 static std::string * g_findp = nullptr;
+static std::string * g_stats = nullptr;
+static std::string * g_check_all = nullptr;
+static std::string * g_progress = nullptr;
 
 static bool is_command(std::string const & cmd, std::string const & line) {
     return line.compare(0, cmd.size(), cmd) == 0;
@@ -344,22 +489,27 @@ void server::process_from(unsigned line_num) {
 
 void server::load_file(std::string const & fname, bool error_if_nofile) {
     interrupt_worker();
+    file_ptr old_file = m_file;
     std::ifstream in(fname);
     if (in.bad() || in.fail()) {
         if (error_if_nofile) {
             m_out << "-- ERROR failed to open file '" << fname << "'" << std::endl;
+            return;
         } else {
+            cancel_check(fname);
             m_file.reset(new file(in, fname));
             m_file_map.erase(fname);
             m_file_map.insert(mk_pair(fname, m_file));
         }
     } else {
+        cancel_check(fname);
         m_cache.clear();
         m_file.reset(new file(in, fname));
         m_file_map.erase(fname);
         m_file_map.insert(mk_pair(fname, m_file));
         process_from(0);
     }
+    check_in_background(old_file);
 }
 
 void server::visit_file(std::string const & fname) {
@@ -369,12 +519,77 @@ void server::visit_file(std::string const & fname) {
         bool error_if_nofile = false;
         load_file(fname, error_if_nofile);
     } else {
+        file_ptr old_file = m_file;
         m_file = it->second;
         m_cache.clear();
-        process_from(0);
+        if (m_checker && m_checker->cancel(m_file) && old_file != m_file) {
+            // file was already checked in the background, we only need to process the last command
+            process_from(std::numeric_limits<unsigned>::max());
+        } else {
+            process_from(0);
+        }
+        check_in_background(old_file);
     }
 }
 
+/** \brief Stop checking (in the background) the file named \c fname. */
+void server::cancel_check(std::string const & fname) {
+    if (!m_checker)
+        return;
+    auto it = m_file_map.find(fname);
+    if (it != m_file_map.end())
+        m_checker->cancel(it->second);
+}
+
+/** \brief Schedule \c f to be checked in the background if it is not the visible file. */
+void server::check_in_background(file_ptr const & f) {
+    if (!m_checker || !f || f == m_file)
+        return;
+    auto it = m_file_map.find(f->get_fname());
+    if (it == m_file_map.end() || it->second != f)
+        return; // f has been reloaded
+    m_worker.wait_inactive(f);
+    m_checker->enqueue(f);
+}
+
+void server::check_all() {
+    if (!m_checker)
+        m_checker.reset(new checker(m_env, m_ios, m_cache, m_base_dir, m_num_threads));
+    std::vector<std::string> fnames;
+    for (auto const & p : m_file_map)
+        fnames.push_back(p.first);
+    // the queue is processed in LIFO order
+    std::sort(fnames.begin(), fnames.end(), std::greater<std::string>());
+    for (std::string const & fname : fnames)
+        check_in_background(m_file_map[fname]);
+}
+
+void server::show_progress() {
+    m_out << "-- BEGINPROGRESS" << std::endl;
+    std::vector<std::string> fnames;
+    for (auto const & p : m_file_map)
+        fnames.push_back(p.first);
+    std::sort(fnames.begin(), fnames.end());
+    for (std::string const & fname : fnames) {
+        file_ptr const & f = m_file_map[fname];
+        m_out << fname << " ";
+        if (f == m_file) {
+            m_out << "visible";
+        } else if (!m_checker) {
+            m_out << "idle";
+        } else {
+            switch (m_checker->get_status(f)) {
+            case check_status::Idle:     m_out << "idle"; break;
+            case check_status::Queued:   m_out << "queued"; break;
+            case check_status::Checking: m_out << "checking"; break;
+            case check_status::Done:     m_out << "done"; break;
+            }
+        }
+        m_out << "\n";
+    }
+    m_out << "-- ENDPROGRESS" << std::endl;
+}
+
 void server::read_line(std::istream & in, std::string & line) {
     if (!std::getline(in, line))
         throw exception("unexpected end of input");
@@ -549,6 +764,13 @@ void server::show_options() {
     m_out << "-- ENDOPTIONS" << std::endl;
 }
 
+void server::show_stats() {
+    m_out << "-- BEGINSTATS" << std::endl;
+    display_stats(m_out, get_stats());
+    display_group_stats(m_out);
+    m_out << "-- ENDSTATS" << std::endl;
+}
+
 void server::show(bool valid) {
     check_file();
     m_out << "-- BEGINSHOW" << std::endl;
@@ -813,10 +1035,23 @@ bool server::operator()(std::istream & in) {
             } else if (is_command(*g_clear_cache, line)) {
                 interrupt_worker();
                 m_cache.clear();
+                m_import_cache.clear();
                 if (m_file)
                     process_from(0);
+                if (m_checker) {
+                    for (auto const & p : m_file_map) {
+                        if (p.second != m_file)
+                            m_checker->enqueue(p.second, true);
+                    }
+                }
+            } else if (is_command(*g_check_all, line)) {
+                check_all();
+            } else if (is_command(*g_progress, line)) {
+                show_progress();
             } else if (is_command(*g_options, line)) {
                 show_options();
+            } else if (is_command(*g_stats, line)) {
+                show_stats();
             } else if (is_command(*g_wait, line)) {
                 optional<unsigned> ms = get_optional_num(line, *g_wait);
                 wait(ms);
@@ -874,6 +1109,9 @@ void initialize_server() {
     g_valid = new std::string("VALID");
     g_sleep = new std::string("SLEEP");
     g_findp = new std::string("FINDP");
+    g_stats = new std::string("STATS");
+    g_check_all = new std::string("CHECK_ALL");
+    g_progress = new std::string("PROGRESS");
 }
 void finalize_server() {
     delete g_auto_completion_max_results;
@@ -895,5 +1133,8 @@ void finalize_server() {
     delete g_valid;
     delete g_sleep;
     delete g_findp;
+    delete g_stats;
+    delete g_check_all;
+    delete g_progress;
 }
 }
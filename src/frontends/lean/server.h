@@ -10,6 +10,7 @@ Author: Leonardo de Moura
 #include <unordered_map>
 #include "util/interrupt.h"
 #include "library/definition_cache.h"
+#include "library/module.h"
 #include "frontends/lean/parser.h"
 #include "frontends/lean/info_manager.h"
 
@@ -20,13 +21,19 @@ namespace lean {
 */
 class server {
     class worker;
+    class checker;
+    /** \brief Status of a file with respect to the background checker */
+    enum class check_status { Idle, Queued, Checking, Done };
     class file {
         friend class server::worker;
+        friend class server::checker;
         std::string               m_fname;
         mutable mutex             m_lines_mutex;
         std::vector<std::string>  m_lines;
         snapshot_vector           m_snapshots;
         info_manager              m_info;
+        check_status              m_status;     // protected by the checker mutex
+        unsigned                  m_check_from; // protected by the checker mutex
 
         unsigned find(unsigned line_num);
         unsigned copy_to(std::string & block, unsigned starting_from);
@@ -39,6 +46,12 @@ class server {
         std::string const & get_fname() const { return m_fname; }
         info_manager const & infom() const { return m_info; }
         void sync(std::vector<std::string> const & lines);
+        /** \brief Parse the file starting at line \c line_num, reusing the snapshots before it.
+            Return the number of lines in the processed block.
+
+            \remark Throws \c interrupted if the current thread is interrupted. */
+        unsigned check(unsigned line_num, snapshot const & empty_snapshot, io_state const & ios,
+                       optional<std::string> const & base_dir, definition_cache & cache);
     };
     typedef std::shared_ptr<file>                     file_ptr;
     typedef std::unordered_map<std::string, file_ptr> file_map;
@@ -52,6 +65,7 @@ class server {
         mutex                 m_todo_mutex;
         condition_variable    m_todo_cv;
         file_ptr              m_last_file;
+        file_ptr              m_active_file; // file being processed
         atomic_bool           m_terminate;
         interruptible_thread  m_thread;
     public:
@@ -61,6 +75,35 @@ class server {
         void set_todo(file_ptr const & f, unsigned line_num, options const & o);
         void request_interrupt();
         bool wait(optional<unsigned> const & ms);
+        /** \brief Block until \c f is not being processed by this worker. */
+        void wait_inactive(file_ptr const & f);
+    };
+    /** \brief Pool of threads for checking files that are not being visited.
+        Files are processed in priority order, the most recently enqueued file first. */
+    class checker {
+        snapshot                                          m_empty_snapshot;
+        definition_cache &                                m_cache;
+        optional<std::string>                             m_base_dir;
+        mutex                                             m_mutex;
+        condition_variable                                m_cv;
+        std::vector<file_ptr>                             m_queue; // back is the next file to be processed
+        std::vector<file_ptr>                             m_active; // m_active[i] is being processed by thread i
+        atomic_bool                                       m_terminate;
+        std::vector<std::unique_ptr<interruptible_thread>> m_threads;
+        void remove_from_queue(file_ptr const & f);
+    public:
+        checker(environment const & env, io_state const & ios, definition_cache & cache,
+                optional<std::string> const & base_dir, unsigned num_threads);
+        ~checker();
+        /** \brief Schedule \c f for checking with the highest priority.
+            If \c force is false, then nothing is done if \c f is already queued, being checked or up to date.
+            Otherwise, \c f is checked from the beginning. */
+        void enqueue(file_ptr const & f, bool force = false);
+        /** \brief Remove \c f from the queue, and interrupt any thread processing it.
+            This method blocks until \c f is not being processed anymore.
+            Return true if \c f had been completely checked. */
+        bool cancel(file_ptr const & f);
+        check_status get_status(file_ptr const & f);
     };
 
     file_map                  m_file_map;
@@ -72,11 +115,17 @@ class server {
     unsigned                  m_num_threads;
     snapshot                  m_empty_snapshot;
     definition_cache          m_cache;
+    import_cache              m_import_cache;
     worker                    m_worker;
+    std::unique_ptr<checker>  m_checker; // not nullptr when checking the whole project
 
     void load_file(std::string const & fname, bool error_if_nofile = true);
     void save_olean(std::string const & fname);
     void visit_file(std::string const & fname);
+    void cancel_check(std::string const & fname);
+    void check_in_background(file_ptr const & f);
+    void check_all();
+    void show_progress();
     void check_file();
     void replace_line(unsigned line_num, std::string const & new_line);
     void insert_line(unsigned line_num, std::string const & new_line);
@@ -93,6 +142,7 @@ class server {
     void read_line(std::istream & in, std::string & line);
     void interrupt_worker();
     void show_options();
+    void show_stats();
     void show(bool valid);
     void sync(std::vector<std::string> const & lines);
     void wait(optional<unsigned> ms);
@@ -5,8 +5,10 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #include <vector>
+#include "util/stats.h"
 #include "library/unfold_macros.h"
 #include "library/abbreviation.h"
+#include "library/compress_proof.h"
 #include "kernel/type_checker.h"
 #include "frontends/lean/theorem_queue.h"
 #include "frontends/lean/parser.h"
@@ -26,12 +28,17 @@ theorem_queue::theorem_queue(parser & p, unsigned num_threads):m_parser(p), m_nu
 }
 void theorem_queue::add(environment const & env, name const & n, level_param_names const & ls, local_level_decls const & lls,
                         expr const & t, expr const & v) {
+    bool collect_stats = m_parser.collecting_stats();
+    options opts       = m_parser.get_options();
     m_queue->add([=]() {
+            scope_stats_group scope(n, collect_stats);
             level_param_names new_ls;
             expr type, value;
             std::tie(type, value, new_ls) = m_parser.elaborate_definition_at(env, lls, n, t, v);
             new_ls = append(ls, new_ls);
             value  = postprocess(env, value);
+            if (get_compress_proofs(opts))
+                value = compress_proof(env, value, opts);
             auto r = check(env, mk_theorem(env, n, new_ls, type, value));
             m_parser.cache_definition(n, t, v, new_ls, type, value);
             return r;
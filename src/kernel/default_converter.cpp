@@ -7,15 +7,20 @@ Author: Leonardo de Moura
 #include "util/interrupt.h"
 #include "util/flet.h"
 #include "util/fresh_name.h"
+#include "util/stats.h"
 #include "kernel/default_converter.h"
 #include "kernel/instantiate.h"
 #include "kernel/free_vars.h"
 #include "kernel/type_checker.h"
 #include "kernel/metavar.h"
 #include "kernel/error_msgs.h"
+#include "kernel/whnf_machine.h"
 
 namespace lean {
 static expr * g_dont_care = nullptr;
+static stats_id g_whnf_stats           = 0;
+static stats_id g_whnf_cache_hit_stats = 0;
+static stats_id g_is_def_eq_stats      = 0;
 
 default_converter::default_converter(environment const & env, bool memoize):
     m_env(env), m_memoize(memoize) {
@@ -34,7 +39,9 @@ optional<expr> default_converter::expand_macro(expr const & m) {
 
 /** \brief Apply normalizer extensions to \c e. */
 optional<pair<expr, constraint_seq>> default_converter::norm_ext(expr const & e) {
-    return m_env.norm_ext()(e, get_extension(*m_tc));
+    if (auto ext = m_norm_ext_index.find(m_env, e))
+        return (*ext)(e, get_extension(*m_tc));
+    return none_ecs();
 }
 
 optional<expr> default_converter::d_norm_ext(expr const & e, constraint_seq & cs) {
@@ -48,14 +55,18 @@ optional<expr> default_converter::d_norm_ext(expr const & e, constraint_seq & cs
 
 /** \brief Return true if \c e may be reduced later after metavariables are instantiated. */
 bool default_converter::is_stuck(expr const & e) {
-    return static_cast<bool>(m_env.norm_ext().is_stuck(e, get_extension(*m_tc)));
+    if (auto ext = m_norm_ext_index.find(m_env, e))
+        return static_cast<bool>(ext->is_stuck(e, get_extension(*m_tc)));
+    return false;
 }
 
 optional<expr> default_converter::is_stuck(expr const & e, type_checker & c) {
     if (is_meta(e)) {
         return some_expr(e);
+    } else if (auto ext = m_norm_ext_index.find(m_env, e)) {
+        return ext->is_stuck(e, get_extension(c));
     } else {
-        return m_env.norm_ext().is_stuck(e, get_extension(c));
+        return none_expr();
     }
 }
 
@@ -92,6 +103,13 @@ expr default_converter::whnf_core(expr const & e) {
             r = e;
         break;
     case expr_kind::App: {
+        if (m_env.whnf_machine()) {
+            expr new_e = whnf_beta_zeta(e);
+            if (!is_eqp(new_e, e)) {
+                r = whnf_core(new_e);
+                break;
+            }
+        }
         buffer<expr> args;
         expr f0 = get_app_rev_args(e, args);
         expr f = whnf_core(f0);
@@ -110,7 +128,10 @@ expr default_converter::whnf_core(expr const & e) {
         break;
     }
     case expr_kind::Let:
-        r = whnf_core(instantiate(let_body(e), let_value(e)));
+        if (m_env.whnf_machine())
+            r = whnf_core(whnf_beta_zeta(e));
+        else
+            r = whnf_core(instantiate(let_body(e), let_value(e)));
         break;
     }
 
@@ -199,12 +220,15 @@ pair<expr, constraint_seq> default_converter::whnf(expr const & e_prime) {
         break;
     }
 
+    stats_inc(g_whnf_stats);
     expr e = e_prime;
     // check cache
     if (m_memoize) {
         auto it = m_whnf_cache.find(e);
-        if (it != m_whnf_cache.end())
+        if (it != m_whnf_cache.end()) {
+            stats_inc(g_whnf_cache_hit_stats);
             return it->second;
+        }
     }
 
     expr t = e;
@@ -591,6 +615,7 @@ bool default_converter::postpone_is_def_eq(expr const & t, expr const & s) {
 
 pair<bool, constraint_seq> default_converter::is_def_eq_core(expr const & t, expr const & s) {
     check_system("is_definitionally_equal");
+    stats_inc(g_is_def_eq_stats);
     constraint_seq cs;
     bool use_hash = true;
     lbool r = quick_is_def_eq(t, s, cs, use_hash);
@@ -656,7 +681,10 @@ pair<expr, constraint_seq> default_converter::whnf(expr const & e, type_checker
 }
 
 void initialize_default_converter() {
-    g_dont_care = new expr(Const("dontcare"));
+    g_dont_care            = new expr(Const("dontcare"));
+    g_whnf_stats           = register_stats_counter(name{"kernel", "whnf"}, "number of (nontrivial) whnf calls in the kernel");
+    g_whnf_cache_hit_stats = register_stats_counter(name{"kernel", "whnf_cache_hit"}, "number of kernel whnf cache hits");
+    g_is_def_eq_stats      = register_stats_counter(name{"kernel", "is_def_eq"}, "number of is_def_eq calls in the kernel");
 }
 
 void finalize_default_converter() {
@@ -25,6 +25,7 @@ protected:
     expr_struct_map<pair<expr, constraint_seq>> m_whnf_cache;
     equiv_manager                               m_eqv_manager;
     expr_pair_set                               m_failure_cache;
+    normalizer_extension_index                  m_norm_ext_index;
 
     // The two auxiliary fields are set when the public methods whnf and is_def_eq are invoked.
     // The goal is to avoid to keep carrying them around.
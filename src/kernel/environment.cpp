@@ -13,9 +13,9 @@ Author: Leonardo de Moura
 
 namespace lean {
 environment_header::environment_header(unsigned trust_lvl, bool prop_proof_irrel, bool eta, bool impredicative,
-                                       std::unique_ptr<normalizer_extension const> ext):
+                                       std::unique_ptr<normalizer_extension const> ext, bool whnf_machine):
     m_trust_lvl(trust_lvl), m_prop_proof_irrel(prop_proof_irrel), m_eta(eta), m_impredicative(impredicative),
-    m_norm_ext(std::move(ext)) {}
+    m_whnf_machine(whnf_machine), m_norm_ext(std::move(ext)) {}
 
 environment_extension::~environment_extension() {}
 
@@ -78,8 +78,9 @@ environment::environment(unsigned trust_lvl, bool prop_proof_irrel, bool eta, bo
 {}
 
 environment::environment(unsigned trust_lvl, bool prop_proof_irrel, bool eta, bool impredicative,
-                         std::unique_ptr<normalizer_extension> ext):
-    m_header(std::make_shared<environment_header>(trust_lvl, prop_proof_irrel, eta, impredicative, std::move(ext))),
+                         std::unique_ptr<normalizer_extension> ext, bool whnf_machine):
+    m_header(std::make_shared<environment_header>(trust_lvl, prop_proof_irrel, eta, impredicative, std::move(ext),
+                                                  whnf_machine)),
     m_extensions(std::make_shared<environment_extensions const>())
 {}
 
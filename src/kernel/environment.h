@@ -47,15 +47,17 @@ class environment_header {
     bool m_prop_proof_irrel;  //!< true if the kernel assumes proof irrelevance for Prop (aka Type.{0})
     bool m_eta;               //!< true if the kernel uses eta-reduction in convertability checks
     bool m_impredicative;     //!< true if the kernel should treat (universe level 0) as a impredicative Prop.
+    bool m_whnf_machine;      //!< true if the kernel uses an abstract machine for beta/let reduction (see whnf_machine.h)
     std::unique_ptr<normalizer_extension const> m_norm_ext;
     void dealloc();
 public:
     environment_header(unsigned trust_lvl, bool prop_proof_irrel, bool eta, bool impredicative,
-                       std::unique_ptr<normalizer_extension const> ext);
+                       std::unique_ptr<normalizer_extension const> ext, bool whnf_machine = false);
     unsigned trust_lvl() const { return m_trust_lvl; }
     bool prop_proof_irrel() const { return m_prop_proof_irrel; }
     bool eta() const { return m_eta; }
     bool impredicative() const { return m_impredicative; }
+    bool whnf_machine() const { return m_whnf_machine; }
     normalizer_extension const & norm_ext() const { return *(m_norm_ext.get()); }
     bool is_recursor(environment const & env, name const & n) const { return m_norm_ext->is_recursor(env, n); }
     bool is_builtin(environment const & env, name const & n) const { return m_norm_ext->is_builtin(env, n); }
@@ -93,6 +95,8 @@ public:
 
     /** \brief Return true iff this object is a descendant of the given one. */
     bool is_descendant(environment_id const & id) const;
+    /** \brief Return true iff this object and the given one identify the same environment. */
+    bool is_eqp(environment_id const & id) const { return m_ptr == id.m_ptr && m_depth == id.m_depth; }
 };
 
 /**
@@ -128,7 +132,7 @@ class environment {
 public:
     environment(unsigned trust_lvl = 0, bool prop_proof_irrel = true, bool eta = true, bool impredicative = true);
     environment(unsigned trust_lvl, bool prop_proof_irrel, bool eta, bool impredicative,
-                std::unique_ptr<normalizer_extension> ext);
+                std::unique_ptr<normalizer_extension> ext, bool whnf_machine = false);
     ~environment();
 
     /** \brief Return the environment unique identifier. */
@@ -153,6 +157,9 @@ public:
     /** \brief Return true iff the environment treats universe level 0 as an impredicative Prop */
     bool impredicative() const { return m_header->impredicative(); }
 
+    /** \brief Return true iff the kernel uses an abstract machine for beta/let reduction */
+    bool whnf_machine() const { return m_header->whnf_machine(); }
+
     /** \brief Return reference to the normalizer extension associatied with this environment. */
     normalizer_extension const & norm_ext() const { return m_header->norm_ext(); }
 
@@ -232,6 +239,7 @@ class name_generator;
 class certified_declaration {
     friend certified_declaration check(environment const & env, declaration const & d,
                                        name_predicate const & opaque_hints);
+    friend certified_declaration check_previously_verified(environment const & env, declaration const & d);
     environment_id m_id;
     declaration    m_declaration;
     certified_declaration(environment_id const & id, declaration const & d):m_id(id), m_declaration(d) {}
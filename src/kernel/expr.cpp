@@ -149,7 +149,9 @@ expr_mlocal::expr_mlocal(bool is_meta, name const & n, expr const & t, tag g):
                    !is_meta || t.has_local(), t.has_param_univ(),
                    1, get_free_var_range(t), g),
     m_name(n),
-    m_type(t) {}
+    m_type(t) {
+    m_hash2 = ::lean::hash(get_hash2(t), m_hash);
+}
 void expr_mlocal::dealloc(buffer<expr_cell*> & todelete) {
     dec_ref(m_type, todelete);
     this->~expr_mlocal();
@@ -172,7 +174,8 @@ expr_composite::expr_composite(expr_kind k, unsigned h, bool has_expr_mv, bool h
                                bool has_local, bool has_param_univ, unsigned w, unsigned fv_range, tag g):
     expr_cell(k, h, has_expr_mv, has_univ_mv, has_local, has_param_univ, g),
     m_weight(w),
-    m_free_var_range(fv_range) {}
+    m_free_var_range(fv_range),
+    m_hash2(0) {}
 
 // Expr applications
 DEF_THREAD_MEMORY_POOL(get_app_allocator, sizeof(expr_app));
@@ -186,7 +189,8 @@ expr_app::expr_app(expr const & fn, expr const & arg, tag g):
                    std::max(get_free_var_range(fn), get_free_var_range(arg)),
                    g),
     m_fn(fn), m_arg(arg) {
-    m_hash = ::lean::hash(m_hash, m_weight);
+    m_hash  = ::lean::hash(m_hash, m_weight);
+    m_hash2 = ::lean::hash(::lean::hash(get_hash2(arg), get_hash2(fn)), 3u);
 }
 void expr_app::dealloc(buffer<expr_cell*> & todelete) {
     dec_ref(m_fn, todelete);
@@ -218,7 +222,8 @@ expr_binding::expr_binding(expr_kind k, name const & n, expr const & t, expr con
                    g),
     m_binder(n, t, i),
     m_body(b) {
-    m_hash = ::lean::hash(m_hash, m_weight);
+    m_hash  = ::lean::hash(m_hash, m_weight);
+    m_hash2 = ::lean::hash(::lean::hash(get_hash2(b), get_hash2(t)), static_cast<unsigned>(k) + 5);
     lean_assert(k == expr_kind::Lambda || k == expr_kind::Pi);
 }
 void expr_binding::dealloc(buffer<expr_cell*> & todelete) {
@@ -253,7 +258,8 @@ expr_let::expr_let(name const & n, expr const & t, expr const & v, expr const &
                    std::max(std::max(get_free_var_range(t), get_free_var_range(v)), dec(get_free_var_range(b))),
                    g),
     m_name(n), m_type(t), m_value(v), m_body(b) {
-    m_hash = ::lean::hash(m_hash, m_weight);
+    m_hash  = ::lean::hash(m_hash, m_weight);
+    m_hash2 = ::lean::hash(::lean::hash(get_hash2(b), get_hash2(v)), get_hash2(t));
 }
 void expr_let::dealloc(buffer<expr_cell*> & todelete) {
     dec_ref(m_body,  todelete);
@@ -318,6 +324,7 @@ expr_macro::expr_macro(macro_definition const & m, unsigned num, expr const * ar
     m_args = new expr[num];
     for (unsigned i = 0; i < m_num_args; i++)
         m_args[i] = args[i];
+    m_hash2 = lean::hash(num, [&](unsigned i) { return get_hash2(args[i]); }, m_hash);
 }
 void expr_macro::dealloc(buffer<expr_cell*> & todelete) {
     for (unsigned i = 0; i < m_num_args; i++) dec_ref(m_args[i], todelete);
@@ -182,8 +182,10 @@ class expr_composite : public expr_cell {
 protected:
     unsigned m_weight;
     unsigned m_free_var_range;
+    unsigned m_hash2;          // secondary structural hash, see get_hash2
     friend unsigned get_weight(expr const & e);
     friend unsigned get_free_var_range(expr const & e);
+    friend unsigned get_hash2(expr const & e);
 public:
     expr_composite(expr_kind k, unsigned h, bool has_expr_mv, bool has_univ_mv, bool has_local,
                    bool has_param_univ, unsigned w, unsigned fv_range, tag g);
@@ -560,6 +562,19 @@ optional<expr> has_expr_metavar_strict(expr const & e);
 inline bool has_local(expr const & e) { return e.has_local(); }
 inline bool has_param_univ(expr const & e) { return e.has_param_univ(); }
 unsigned get_weight(expr const & e);
+/**
+   \brief Secondary structural hash code. It is computed using a different combination function,
+   and together with \c hash it forms a 64-bit code used to quickly decide that two expressions
+   are not structurally equal. Binder names and binder information are ignored.
+*/
+inline unsigned get_hash2(expr const & e) {
+    switch (e.kind()) {
+    case expr_kind::Var: case expr_kind::Constant: case expr_kind::Sort:
+        return hash(e.hash(), static_cast<unsigned>(e.kind()) + 1);
+    default:
+        return static_cast<expr_composite*>(e.raw())->m_hash2;
+    }
+}
 /**
    \brief Return \c R s.t. the de Bruijn index of all free variables
    occurring in \c e is in the interval <tt>[0, R)</tt>.
@@ -15,6 +15,14 @@ Author: Leonardo de Moura
 #define LEAN_EQ_CACHE_CAPACITY 1024*8
 #endif
 
+#ifndef LEAN_EQ_MEMO_CAPACITY
+#define LEAN_EQ_MEMO_CAPACITY 1024
+#endif
+
+#ifndef LEAN_EQ_MEMO_MIN_WEIGHT
+#define LEAN_EQ_MEMO_MIN_WEIGHT 32
+#endif
+
 namespace lean {
 struct eq_cache {
     struct entry {
@@ -51,6 +59,71 @@ struct eq_cache {
 
 MK_THREAD_LOCAL_GET_DEF(eq_cache, get_eq_cache);
 
+/** \brief Equality memo that survives different calls to \c is_equal/is_bi_equal.
+
+    It is a union-find style structure: each entry maps a node to a representative of
+    its equivalence class, and two nodes are known to be equal if they have the same representative.
+    The table is direct mapped and bounded, so a collision just forgets an old fact.
+    We only store big terms (see LEAN_EQ_MEMO_MIN_WEIGHT), comparing small terms is cheap.
+
+    Remark: the entries store references to the nodes. Thus, pointer equality on
+    representatives is sound. */
+struct eq_memo {
+    /* Remark: we use optional<expr> because the default constructor of expr
+       relies on objects created by initialize_expr. */
+    struct entry {
+        optional<expr> m_node;
+        optional<expr> m_repr;
+        bool contains(expr const & e) const { return m_node && is_eqp(*m_node, e); }
+    };
+    std::vector<entry> m_table;
+    eq_memo():m_table(LEAN_EQ_MEMO_CAPACITY) {}
+
+    static bool use(expr const & a) {
+        return get_weight(a) >= LEAN_EQ_MEMO_MIN_WEIGHT && is_shared(a);
+    }
+
+    entry & get_entry(expr const & e) {
+        return m_table[e.hash_alloc() % LEAN_EQ_MEMO_CAPACITY];
+    }
+
+    expr const & find(expr const & e) {
+        entry & it = get_entry(e);
+        if (!it.contains(e))
+            return e;
+        expr const & repr = *it.m_repr;
+        entry & r = get_entry(repr);
+        if (r.contains(repr) && !is_eqp(*r.m_repr, repr)) {
+            /* path compression */
+            it.m_repr = r.m_repr;
+        }
+        return *it.m_repr;
+    }
+
+    bool check(expr const & a, expr const & b) {
+        expr_cell * ra = find(a).raw();
+        return ra == find(b).raw();
+    }
+
+    void merge(expr const & a, expr const & b) {
+        expr ra = find(a);
+        expr rb = find(b);
+        if (is_eqp(ra, rb))
+            return;
+        entry & ea = get_entry(ra);
+        ea.m_node  = ra;
+        ea.m_repr  = rb;
+        if (!is_eqp(a, ra)) {
+            entry & e = get_entry(a);
+            e.m_node  = a;
+            e.m_repr  = rb;
+        }
+    }
+};
+
+MK_THREAD_LOCAL_GET_DEF(eq_memo, get_eq_memo);
+MK_THREAD_LOCAL_GET_DEF(eq_memo, get_bi_eq_memo);
+
 /** \brief Functional object for comparing expressions.
 
     Remark if CompareBinderInfo is true, then functional object will also compare
@@ -58,6 +131,7 @@ MK_THREAD_LOCAL_GET_DEF(eq_cache, get_eq_cache);
 template<bool CompareBinderInfo>
 class expr_eq_fn {
     eq_cache & m_cache;
+    eq_memo  & m_memo;
 
     static void check_system() { ::lean::check_system("expression equality test"); }
 
@@ -66,8 +140,19 @@ class expr_eq_fn {
         if (a.hash() != b.hash())  return false;
         if (a.kind() != b.kind())  return false;
         if (is_var(a))             return var_idx(a) == var_idx(b);
+        if (get_hash2(a) != get_hash2(b)) return false;
+        bool memo = eq_memo::use(a) && eq_memo::use(b);
+        if (memo && m_memo.check(a, b))
+            return true;
         if (m_cache.check(a, b))
             return true;
+        bool r = apply_core(a, b);
+        if (r && memo)
+            m_memo.merge(a, b);
+        return r;
+    }
+
+    bool apply_core(expr const & a, expr const & b) {
         switch (a.kind()) {
         case expr_kind::Var:
             lean_unreachable(); // LCOV_EXCL_LINE
@@ -119,7 +204,7 @@ class expr_eq_fn {
         lean_unreachable(); // LCOV_EXCL_LINE
     }
 public:
-    expr_eq_fn():m_cache(get_eq_cache()) {}
+    expr_eq_fn():m_cache(get_eq_cache()), m_memo(CompareBinderInfo ? get_bi_eq_memo() : get_eq_memo()) {}
     ~expr_eq_fn() { m_cache.clear(); }
     bool operator()(expr const & a, expr const & b) { return apply(a, b); }
 };
@@ -19,6 +19,9 @@ public:
     virtual bool supports(name const & feature) const;
     virtual bool is_recursor(environment const & env, name const & n) const;
     virtual bool is_builtin(environment const & env, name const & n) const;
+    virtual normalizer_extension const * get_reducer(environment const & env, name const & n) const {
+        return is_recursor(env, n) ? this : nullptr;
+    }
 };
 
 /** \brief The following function must be invoked to register the builtin HITs computation rules in the kernel. */
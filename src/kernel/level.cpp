@@ -18,6 +18,14 @@ Author: Leonardo de Moura
 #include "kernel/level.h"
 #include "kernel/environment.h"
 
+#ifndef LEAN_LEVEL_NORMALIZE_CACHE_SIZE
+#define LEAN_LEVEL_NORMALIZE_CACHE_SIZE 1023
+#endif
+
+#ifndef LEAN_LEVEL_GEQ_CACHE_SIZE
+#define LEAN_LEVEL_GEQ_CACHE_SIZE 4093
+#endif
+
 namespace lean {
 level cache(level const & e);
 
@@ -208,6 +216,14 @@ pair<level, unsigned> to_offset(level l) {
     return mk_pair(l, k);
 }
 
+/** \brief Return \c l' s.t. l == succ^k(l') and l' is not a succ. */
+static level const & to_offset_base(level const & l) {
+    level const * it = &l;
+    while (is_succ(*it))
+        it = &succ_of(*it);
+    return *it;
+}
+
 unsigned to_explicit(level const & l) {
     lean_assert(is_explicit(l));
     return to_offset(l).second;
@@ -261,6 +277,8 @@ level const & mk_level_zero() { return *g_level_zero; }
 level const & mk_level_one() { return *g_level_one; }
 bool is_one(level const & l) { return l == mk_level_one(); }
 
+static void clear_level_memo_caches();
+
 typedef typename std::unordered_set<level, level_hash> level_cache;
 LEAN_THREAD_VALUE(bool, g_level_cache_enabled, true);
 MK_THREAD_LOCAL_GET_DEF(level_cache, get_level_cache);
@@ -271,6 +289,7 @@ bool enable_level_caching(bool f) {
     get_level_cache().swap(new_cache);
     get_level_cache().insert(mk_level_zero());
     get_level_cache().insert(mk_level_one());
+    clear_level_memo_caches();
     return r;
 }
 level cache(level const & e) {
@@ -657,7 +676,78 @@ level mk_succ(level l, unsigned k) {
     return l;
 }
 
+/* Direct mapped caches for \c normalize and \c is_geq.
+   Levels are hash-consed, so the keys are usually checked using pointer equality. */
+class level_normalize_cache {
+    std::vector<optional<pair<level, level>>> m_cache;
+public:
+    optional<level> find(level const & l) const {
+        if (m_cache.empty())
+            return none_level();
+        if (auto const & e = m_cache[l.hash() % m_cache.size()]) {
+            if (e->first == l)
+                return some_level(e->second);
+        }
+        return none_level();
+    }
+    void save(level const & l, level const & r) {
+        if (m_cache.empty())
+            m_cache.resize(LEAN_LEVEL_NORMALIZE_CACHE_SIZE);
+        m_cache[l.hash() % m_cache.size()] = mk_pair(l, r);
+    }
+    void clear() { m_cache.clear(); }
+};
+
+class level_geq_cache {
+    struct entry {
+        level m_lhs;
+        level m_rhs;
+        bool  m_result;
+        entry(level const & lhs, level const & rhs, bool r):m_lhs(lhs), m_rhs(rhs), m_result(r) {}
+    };
+    std::vector<optional<entry>> m_cache;
+    unsigned idx(level const & l1, level const & l2) const { return hash(l1.hash(), l2.hash()) % m_cache.size(); }
+public:
+    optional<bool> find(level const & l1, level const & l2) const {
+        if (m_cache.empty())
+            return optional<bool>();
+        if (auto const & e = m_cache[idx(l1, l2)]) {
+            if (e->m_lhs == l1 && e->m_rhs == l2)
+                return optional<bool>(e->m_result);
+        }
+        return optional<bool>();
+    }
+    void save(level const & l1, level const & l2, bool r) {
+        if (m_cache.empty())
+            m_cache.resize(LEAN_LEVEL_GEQ_CACHE_SIZE);
+        m_cache[idx(l1, l2)] = entry(l1, l2, r);
+    }
+    void clear() { m_cache.clear(); }
+};
+
+MK_THREAD_LOCAL_GET_DEF(level_normalize_cache, get_level_normalize_cache);
+MK_THREAD_LOCAL_GET_DEF(level_geq_cache, get_level_geq_cache);
+
+static void clear_level_memo_caches() {
+    get_level_normalize_cache().clear();
+    get_level_geq_cache().clear();
+}
+
+static level normalize_core(level const & l);
+
 level normalize(level const & l) {
+    level const & r = to_offset_base(l);
+    if (!is_max(r) && !is_imax(r))
+        return l; // already in normal form
+    level_normalize_cache & cache = get_level_normalize_cache();
+    if (auto n = cache.find(l))
+        return *n;
+    level n = normalize_core(l);
+    cache.save(l, n);
+    return n;
+}
+
+static level normalize_core(level const & l) {
     auto p = to_offset(l);
     level const & r = p.first;
     switch (kind(r)) {
@@ -749,7 +839,14 @@ bool is_geq_core(level l1, level l2) {
     return false;
 }
 bool is_geq(level const & l1, level const & l2) {
-    return is_geq_core(normalize(l1), normalize(l2));
+    if (is_eqp(l1, l2) || is_zero(l2))
+        return true;
+    level_geq_cache & cache = get_level_geq_cache();
+    if (auto r = cache.find(l1, l2))
+        return *r;
+    bool r = is_geq_core(normalize(l1), normalize(l2));
+    cache.save(l1, l2, r);
+    return r;
 }
 levels param_names_to_levels(level_param_names const & ps) {
     return map2<level>(ps, [](name const & p) { return mk_param_univ(p); });
@@ -4,6 +4,7 @@ Released under Apache 2.0 license as described in the file LICENSE.
 
 Author: Leonardo de Moura
 */
+#include "kernel/environment.h"
 #include "kernel/normalizer_extension.h"
 
 namespace lean {
@@ -16,6 +17,7 @@ public:
     virtual bool supports(name const &) const { return false; }
     virtual bool is_recursor(environment const &, name const &) const { return false; }
     virtual bool is_builtin(environment const &, name const &) const { return false; }
+    virtual normalizer_extension const * get_reducer(environment const &, name const &) const { return nullptr; }
 };
 
 std::unique_ptr<normalizer_extension> mk_id_normalizer_extension() {
@@ -54,9 +56,31 @@ public:
     virtual bool is_builtin(environment const & env, name const & n) const {
         return m_ext1->is_builtin(env, n) || m_ext2->is_builtin(env, n);
     }
+
+    virtual normalizer_extension const * get_reducer(environment const & env, name const & n) const {
+        normalizer_extension const * r1 = m_ext1->get_reducer(env, n);
+        normalizer_extension const * r2 = m_ext2->get_reducer(env, n);
+        if (!r1)
+            return r2;
+        else if (!r2)
+            return r1;
+        else
+            return this;
+    }
 };
 
 std::unique_ptr<normalizer_extension> compose(std::unique_ptr<normalizer_extension> && ext1, std::unique_ptr<normalizer_extension> && ext2) {
     return std::unique_ptr<normalizer_extension>(new comp_normalizer_extension(std::move(ext1), std::move(ext2)));
 }
+
+normalizer_extension const * normalizer_extension_index::find(environment const & env, expr const & e) {
+    expr const & fn = get_app_fn(e);
+    if (!is_constant(fn))
+        return nullptr;
+    if (auto it = m_cache.find(const_name(fn)))
+        return *it;
+    normalizer_extension const * r = env.norm_ext().get_reducer(env, const_name(fn));
+    m_cache.insert(const_name(fn), r);
+    return r;
+}
 }
@@ -5,6 +5,7 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #pragma once
+#include "util/name_map.h"
 #include "kernel/expr.h"
 
 namespace lean {
@@ -27,6 +28,29 @@ public:
     virtual bool supports(name const & feature) const = 0;
     virtual bool is_recursor(environment const & env, name const & n) const = 0;
     virtual bool is_builtin(environment const & env, name const & n) const = 0;
+    /** \brief Return the extension (i.e., \c this or one of its components) that reduces applications
+        of the constant \c n, or nullptr if there is none.
+
+        The default implementation is conservative, and always returns \c this.
+        Extensions that only reduce (and get stuck at) applications of recursors should
+        return \c this iff \c is_recursor(env, n). */
+    virtual normalizer_extension const * get_reducer(environment const &, name const &) const {
+        return this;
+    }
+};
+
+/**
+   \brief Map from constant names to the normalizer extension that reduces their applications
+   (see \c normalizer_extension::get_reducer). It is used to avoid the chain of extensions
+   for applications of constants that are not recursors (e.g., definitions and constructors).
+
+   \remark The cache assumes the environment does not change. */
+class normalizer_extension_index {
+    name_map<normalizer_extension const *> m_cache;
+public:
+    /** \brief Return the extension that may reduce \c e, or nullptr if \c e is not the application of a recursor. */
+    normalizer_extension const * find(environment const & env, expr const & e);
+    void clear() { m_cache = name_map<normalizer_extension const *>(); }
 };
 
 inline optional<pair<expr, constraint_seq>> none_ecs() { return optional<pair<expr, constraint_seq>>(); }
@@ -12,6 +12,7 @@ Author: Leonardo de Moura
 #include "util/sstream.h"
 #include "util/scoped_map.h"
 #include "util/fresh_name.h"
+#include "util/stats.h"
 #include "kernel/type_checker.h"
 #include "kernel/default_converter.h"
 #include "kernel/expr_maps.h"
@@ -24,6 +25,9 @@ Author: Leonardo de Moura
 #include "kernel/replace_fn.h"
 
 namespace lean {
+static stats_id g_infer_type_stats           = 0;
+static stats_id g_infer_type_cache_hit_stats = 0;
+
 expr replace_range(expr const & type, expr const & new_range) {
     if (is_pi(type))
         return update_binding(type, binding_domain(type), replace_range(binding_body(type), new_range));
@@ -300,23 +304,60 @@ pair<expr, constraint_seq> type_checker::infer_app(expr const & e, bool infer_on
     }
 }
 
+/**
+   \brief Infer the type of a let-expression.
+
+   We process a sequence of nested let-expressions at once. A let-variable whose type is a proposition
+   is replaced with a local constant, and its value is only substituted in the resulting type
+   when it occurs there. By proof irrelevance, the body does not depend on which proof the local
+   stands for. So, terms containing many let-expressions (e.g., proofs produced by \c compress_proof)
+   are not copied for each one of them. The values of the other let-variables are substituted in the body.
+*/
 pair<expr, constraint_seq> type_checker::infer_let(expr const & e, bool infer_only) {
-    if (!infer_only) {
-        pair<expr, constraint_seq> dtcs = infer_type_core(let_type(e), infer_only);
-        pair<expr, constraint_seq> scs  = ensure_sort_core(dtcs.first, e);
-        pair<expr, constraint_seq> vcs  = infer_type_core(let_value(e), infer_only);
-        expr v_type = vcs.first;
-        // TODO(Leo): we will remove justifications in the future.
-        as_delayed_justification jst(mk_justification("let mismatch"));
-        pair<bool, constraint_seq> dcs  = is_def_eq(v_type, let_type(e), jst);
-        if (!dcs.first) {
-            throw_kernel_exception(m_env, e,
-                                   [=](formatter const & fmt) {
-                                       return pp_def_type_mismatch(fmt, let_name(e), let_type(e), v_type, true);
-                                   });
+    buffer<expr> vars;
+    buffer<expr> vals;
+    constraint_seq cs;
+    expr it = e;
+    while (is_let(it)) {
+        expr type  = instantiate_rev(let_type(it), vars.size(), vars.data());
+        expr value = instantiate_rev(let_value(it), vars.size(), vars.data());
+        if (!infer_only) {
+            expr d_type = infer_type_core(type, infer_only, cs);
+            cs = cs + ensure_sort_core(d_type, e).second;
+            expr v_type = infer_type_core(value, infer_only, cs);
+            // TODO(Leo): we will remove justifications in the future.
+            as_delayed_justification jst(mk_justification("let mismatch"));
+            pair<bool, constraint_seq> dcs  = is_def_eq(v_type, type, jst);
+            if (!dcs.first) {
+                name n = let_name(it);
+                throw_kernel_exception(m_env, e,
+                                       [=](formatter const & fmt) {
+                                           return pp_def_type_mismatch(fmt, n, type, v_type, true);
+                                       });
+            }
+            cs = cs + dcs.second;
+        }
+        pair<bool, constraint_seq> pcs = is_prop(type);
+        vals.push_back(value);
+        if (pcs.first) {
+            cs = cs + pcs.second;
+            vars.push_back(mk_local(mk_fresh_name(), let_name(it), type, binder_info()));
+        } else {
+            vars.push_back(value);
         }
+        it = let_body(it);
     }
-    return infer_type_core(instantiate(let_body(e), let_value(e)), infer_only);
+    expr r = infer_type_core(instantiate_rev(it, vars.size(), vars.data()), infer_only, cs);
+    unsigned i = vars.size();
+    while (i > 0) {
+        --i;
+        if (is_local(vars[i]) && !is_eqp(vars[i], vals[i])) {
+            expr new_type = abstract_local(r, vars[i]);
+            if (!closed(new_type))
+                r = instantiate(new_type, vals[i]);
+        }
+    }
+    return mk_pair(r, cs);
 }
 
 expr type_checker::infer_type_core(expr const & e, bool infer_only, constraint_seq & cs) {
@@ -337,10 +378,13 @@ pair<expr, constraint_seq> type_checker::infer_type_core(expr const & e, bool in
     lean_assert(closed(e));
     check_system("type checker");
 
+    stats_inc(g_infer_type_stats);
     if (m_memoize) {
         auto it = m_infer_type_cache[infer_only].find(e);
-        if (it != m_infer_type_cache[infer_only].end())
+        if (it != m_infer_type_cache[infer_only].end()) {
+            stats_inc(g_infer_type_cache_hit_stats);
             return it->second;
+        }
     }
 
     pair<expr, constraint_seq> r;
@@ -512,7 +556,19 @@ certified_declaration check(environment const & env, declaration const & d) {
     return check(env, d, [](name const &) { return false; });
 }
 
+certified_declaration check_previously_verified(environment const & env, declaration const & d) {
+    if (d.is_definition())
+        check_no_mlocal(env, d.get_name(), d.get_value(), false);
+    check_no_mlocal(env, d.get_name(), d.get_type(), true);
+    check_name(env, d.get_name());
+    check_duplicated_params(env, d);
+    return certified_declaration(env.get_id(), d);
+}
+
 void initialize_type_checker() {
+    g_infer_type_stats           = register_stats_counter(name{"kernel", "infer_type"}, "number of infer_type calls in the kernel");
+    g_infer_type_cache_hit_stats = register_stats_counter(name{"kernel", "infer_type_cache_hit"},
+                                                          "number of kernel infer_type cache hits");
 }
 
 void finalize_type_checker() {
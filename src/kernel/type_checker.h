@@ -260,6 +260,14 @@ void check_no_metavar(environment const & env, name const & n, expr const & e, b
 */
 certified_declaration check(environment const & env, declaration const & d);
 certified_declaration check(environment const & env, declaration const & d, name_predicate const & opaque_hints);
+/**
+   \brief Certify a declaration that has already been type checked in a previous run.
+   Only the cheap syntactic checks (name, universe parameters, free variables) are performed.
+
+   \remark This function should only be used when the caller has evidence that \c d (and everything it depends on)
+   was checked before, e.g., by consulting a verification ledger.
+*/
+certified_declaration check_previously_verified(environment const & env, declaration const & d);
 
 /**
     \brief Create a justification for an application \c e where the expected type must be \c d_type and
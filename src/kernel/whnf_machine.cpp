@@ -0,0 +1,110 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <unordered_map>
+#include "util/list.h"
+#include "util/buffer.h"
+#include "util/interrupt.h"
+#include "kernel/instantiate.h"
+#include "kernel/whnf_machine.h"
+
+namespace lean {
+class whnf_machine_fn {
+    struct closure;
+    /* The head of the environment is the value of the free variable 0. */
+    typedef list<closure> env;
+    struct closure {
+        expr m_expr;
+        env  m_env;
+        closure(expr const & e, env const & s):m_expr(e), m_env(s) {}
+    };
+    /* read back cache for environment cells, i.e., it maps \c s to read_back(head(s)). */
+    std::unordered_map<void const *, expr> m_cache;
+
+    expr read_back_head(env const & s) {
+        auto it = m_cache.find(s.raw());
+        if (it != m_cache.end())
+            return it->second;
+        expr r = read_back(head(s).m_expr, head(s).m_env);
+        m_cache.insert(mk_pair(s.raw(), r));
+        return r;
+    }
+
+    expr read_back(expr const & e, env const & s) {
+        unsigned n = get_free_var_range(e);
+        if (n == 0 || !s)
+            return e;
+        buffer<expr> subst;
+        env const * it = &s;
+        while (subst.size() < n && *it) {
+            subst.push_back(read_back_head(*it));
+            it = &tail(*it);
+        }
+        return instantiate(e, subst.size(), subst.data());
+    }
+
+public:
+    expr operator()(expr const & e) {
+        expr t = e;
+        env  s;
+        buffer<closure> stack; // the last element is the first argument
+        bool progress = false;
+        while (true) {
+            check_system("whnf");
+            switch (t.kind()) {
+            case expr_kind::Var: {
+                unsigned idx   = var_idx(t);
+                env const * it = &s;
+                while (idx > 0 && *it) {
+                    it = &tail(*it);
+                    idx--;
+                }
+                if (!*it)
+                    break; // free variable of e
+                closure c = head(*it);
+                t = c.m_expr;
+                s = c.m_env;
+                continue;
+            }
+            case expr_kind::App:
+                stack.push_back(closure(app_arg(t), s));
+                t = app_fn(t);
+                continue;
+            case expr_kind::Lambda:
+                if (stack.empty())
+                    break;
+                s = env(stack.back(), s);
+                stack.pop_back();
+                t = binding_body(t);
+                progress = true;
+                continue;
+            case expr_kind::Let:
+                s = env(closure(let_value(t), s), s);
+                t = let_body(t);
+                progress = true;
+                continue;
+            case expr_kind::Sort:  case expr_kind::Constant: case expr_kind::Meta:
+            case expr_kind::Local: case expr_kind::Pi:       case expr_kind::Macro:
+                break;
+            }
+            break;
+        }
+        if (!progress)
+            return e;
+        buffer<expr> args;
+        unsigned i = stack.size();
+        while (i > 0) {
+            --i;
+            args.push_back(read_back(stack[i].m_expr, stack[i].m_env));
+        }
+        return mk_app(read_back(t, s), args);
+    }
+};
+
+expr whnf_beta_zeta(expr const & e) {
+    return whnf_machine_fn()(e);
+}
+}
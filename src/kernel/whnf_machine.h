@@ -0,0 +1,27 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include "kernel/expr.h"
+
+namespace lean {
+/**
+   \brief Beta and zeta (let) reduce the head of \c e using a Krivine-style abstract machine.
+
+   The machine state is a term, an environment of closures for its free variables, and
+   a stack of argument closures. Reduction steps just push and pop closures, and the
+   result is only read back (i.e., instantiated) when the machine stops. So, we avoid
+   the intermediate terms created by calling \c instantiate at each step.
+
+   The machine stops at a head that is not a lambda (with arguments) nor a let-expression.
+   In particular, it does not expand macros, unfold definitions nor apply normalizer extensions.
+   If no reduction step is performed, then the result is \c e itself (pointer equality).
+
+   \remark The kernel uses the machine when the environment was created with the \c whnf_machine flag,
+   and \c type_context when the \c whnf_machine option is set.
+*/
+expr whnf_beta_zeta(expr const & e);
+}
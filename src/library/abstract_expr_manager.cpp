@@ -9,8 +9,53 @@ Author: Daniel Selsam
 #include "util/list_fn.h"
 
 namespace lean {
+bool abstract_expr_manager::use_cache(expr const & e) {
+    return (is_app(e) || is_binding(e)) && closed(e);
+}
 
 unsigned abstract_expr_manager::hash(expr const & e) {
+    if (!use_cache(e))
+        return hash_core(e);
+    auto it = m_cache.find(e);
+    if (it != m_cache.end())
+        return it->second.m_hash;
+    unsigned h = hash_core(e);
+    m_cache.insert(mk_pair(e, info(h)));
+    return h;
+}
+
+expr const & abstract_expr_manager::get_repr(expr const & e) {
+    lean_assert(use_cache(e));
+    unsigned h = hash(e);
+    info & i   = m_cache.find(e)->second;
+    if (i.m_repr)
+        return *i.m_repr;
+    /* Remark: is_equal_core may add new representatives to m_reprs[h]. So, we should not
+       keep references to its elements. */
+    for (unsigned j = 0; j < m_reprs[h].size(); j++) {
+        expr r = m_reprs[h][j];
+        if (is_equal_core(e, r)) {
+            i.m_repr = r;
+            return *i.m_repr;
+        }
+    }
+    m_reprs[h].push_back(e);
+    i.m_repr = e;
+    return e;
+}
+
+bool abstract_expr_manager::is_equal(expr const & a, expr const & b) {
+    if (is_eqp(a, b))          return true;
+    if (a.kind() != b.kind())  return false;
+    if (use_cache(a) && use_cache(b)) {
+        if (hash(a) != hash(b))
+            return false;
+        return is_eqp(get_repr(a), get_repr(b));
+    }
+    return is_equal_core(a, b);
+}
+
+unsigned abstract_expr_manager::hash_core(expr const & e) {
     unsigned h;
     switch (e.kind()) {
     case expr_kind::Constant:
@@ -64,7 +109,7 @@ unsigned abstract_expr_manager::hash(expr const & e) {
     lean_unreachable();
 }
 
-bool abstract_expr_manager::is_equal(expr const & a, expr const & b) {
+bool abstract_expr_manager::is_equal_core(expr const & a, expr const & b) {
     if (is_eqp(a, b))          return true;
     if (a.kind() != b.kind())  return false;
     if (is_var(a))             return var_idx(a) == var_idx(b);
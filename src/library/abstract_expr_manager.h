@@ -5,7 +5,9 @@ Author: Daniel Selsam
 */
 #pragma once
 #include <vector>
+#include <unordered_map>
 #include "kernel/expr.h"
+#include "kernel/expr_maps.h"
 #include "library/type_context.h"
 #include "library/congr_lemma_manager.h"
 
@@ -21,6 +23,21 @@ class abstract_expr_manager {
     std::vector<expr>     m_locals;
     type_context        & m_tctx;
     congr_lemma_manager & m_congr_lemma_manager;
+    /* The abstract hash code and the canonical representative of applications and binders
+       without loose bound variables are memoized. The canonical representative of \c e is the
+       first expression (checked by this object) that is equal to \c e modulo subsingletons.
+       So, two of these expressions are equal iff their representatives are pointer equal. */
+    struct info {
+        unsigned       m_hash;
+        optional<expr> m_repr;
+        info(unsigned h):m_hash(h) {}
+    };
+    expr_map<info>                                   m_cache;
+    std::unordered_map<unsigned, std::vector<expr>>  m_reprs; // hash code -> canonical representatives
+    static bool use_cache(expr const & e);
+    unsigned hash_core(expr const & e);
+    bool is_equal_core(expr const & a, expr const & b);
+    expr const & get_repr(expr const & e);
 public:
     abstract_expr_manager(congr_lemma_manager & c_lemma_manager):
         m_tctx(c_lemma_manager.ctx()), m_congr_lemma_manager(c_lemma_manager) {}
@@ -10,76 +10,97 @@ Author: Leonardo de Moura
 #include "kernel/abstract.h"
 #include "library/trace.h"
 #include "library/match.h"
+#include "library/idx_metavar.h"
 #include "library/constants.h"
 #include "library/app_builder.h"
 #include "library/tmp_type_context.h"
 #include "library/relation_manager.h"
+#include "library/shared_environment_cache.h"
 
 namespace lean {
-struct app_builder::imp {
-    tmp_type_context * m_ctx;
-    bool               m_ctx_owner;
+/* Plan for assigning an explicit argument \c a without using unification.
+   If \c m_type_mvar is not none, then the type of the metavariable for \c a is \c m_type_mvar,
+   and the type of \c m_type_mvar is (Sort (succ^m_offset m_type_uvar)).
+   So, when these metavariables are not assigned yet, they are determined by the type of \c a.
+   Example: the explicit argument of (@eq.refl ?A ?a). */
+struct app_builder_arg_plan {
+    optional<expr> m_type_mvar;
+    level          m_type_uvar;
+    unsigned       m_offset{0};
+};
 
-    struct entry {
-        unsigned             m_num_umeta;
-        unsigned             m_num_emeta;
-        expr                 m_app;
-        list<optional<expr>> m_inst_args; // "mask" of implicit instance arguments
-        list<expr>           m_expl_args; // metavars for explicit arguments
-
-        /*
-          IMPORTANT: for m_inst_args we store the arguments in reverse order.
-          For example, the first element in the list indicates whether the last argument
-          is an instance implicit argument or not. If it is not none, then the element
-          is the associated metavariable
-
-          m_expl_args are also stored in reverse order
-        */
-    };
-
-    struct key {
-        name       m_name;
-        unsigned   m_num_expl;
-        unsigned   m_hash;
-        // If nil, then the mask is composed of the last m_num_expl arguments.
-        // If nonnil, then the mask is NOT of the form [false*, true*]
-        list<bool> m_mask;
-
-        key(name const & c, unsigned n):
-            m_name(c), m_num_expl(n),
-            m_hash(::lean::hash(c.hash(), n)) {
-        }
-
-        key(name const & c, list<bool> const & m):
-            m_name(c), m_num_expl(length(m)) {
-            m_hash = ::lean::hash(c.hash(), m_num_expl);
-            m_mask = m;
-            for (bool b : m) {
-                if (b)
-                    m_hash = ::lean::hash(m_hash, 17u);
-                else
-                    m_hash = ::lean::hash(m_hash, 31u);
-            }
-        }
+struct app_builder_entry {
+    unsigned                   m_num_umeta;
+    unsigned                   m_num_emeta;
+    expr                       m_app;
+    list<optional<expr>>       m_inst_args; // "mask" of implicit instance arguments
+    list<expr>                 m_expl_args; // metavars for explicit arguments
+    list<app_builder_arg_plan> m_expl_plan; // plan for each explicit argument
+    /*
+      IMPORTANT: for m_inst_args we store the arguments in reverse order.
+      For example, the first element in the list indicates whether the last argument
+      is an instance implicit argument or not. If it is not none, then the element
+      is the associated metavariable
+
+      m_expl_args and m_expl_plan are also stored in reverse order
+    */
+};
 
-        bool check_invariant() const {
-            lean_assert(empty(m_mask) || length(m_mask) == m_num_expl);
-            return true;
+struct app_builder_key {
+    name       m_name;
+    unsigned   m_num_expl;
+    unsigned   m_hash;
+    // If nil, then the mask is composed of the last m_num_expl arguments.
+    // If nonnil, then the mask is NOT of the form [false*, true*]
+    list<bool> m_mask;
+
+    app_builder_key(name const & c, unsigned n):
+        m_name(c), m_num_expl(n),
+        m_hash(::lean::hash(c.hash(), n)) {
+    }
+
+    app_builder_key(name const & c, list<bool> const & m):
+        m_name(c), m_num_expl(length(m)) {
+        m_hash = ::lean::hash(c.hash(), m_num_expl);
+        m_mask = m;
+        for (bool b : m) {
+            if (b)
+                m_hash = ::lean::hash(m_hash, 17u);
+            else
+                m_hash = ::lean::hash(m_hash, 31u);
         }
+    }
 
-        unsigned hash() const {
-            return m_hash;
-        }
+    bool check_invariant() const {
+        lean_assert(empty(m_mask) || length(m_mask) == m_num_expl);
+        return true;
+    }
 
-        friend bool operator==(key const & k1, key const & k2) {
-            return k1.m_name == k2.m_name && k1.m_num_expl == k2.m_num_expl && k1.m_mask == k2.m_mask;
-        }
-    };
+    unsigned hash() const {
+        return m_hash;
+    }
+
+    friend bool operator==(app_builder_key const & k1, app_builder_key const & k2) {
+        return k1.m_name == k2.m_name && k1.m_num_expl == k2.m_num_expl && k1.m_mask == k2.m_mask;
+    }
+};
 
-    struct key_hash_fn {
-        unsigned operator()(key const & k) const { return k.hash(); }
-    };
+struct app_builder_key_hash_fn {
+    unsigned operator()(app_builder_key const & k) const { return k.hash(); }
+};
+
+/* The entries only depend on the declarations in the environment. So, they are shared by all
+   app_builder objects (and threads) using the same environment. */
+typedef shared_environment_cache<app_builder_key, app_builder_entry, app_builder_key_hash_fn> app_builder_cache;
+static app_builder_cache * g_app_builder_cache = nullptr;
+
+struct app_builder::imp {
+    tmp_type_context * m_ctx;
+    bool               m_ctx_owner;
 
+    typedef app_builder_entry       entry;
+    typedef app_builder_key         key;
+    typedef app_builder_key_hash_fn key_hash_fn;
     typedef std::unordered_map<key, entry, key_hash_fn> map;
 
     map               m_map;
@@ -132,11 +153,50 @@ struct app_builder::imp {
         return lvls;
     }
 
+    optional<entry> find_entry(key const & k) {
+        auto it = m_map.find(k);
+        if (it != m_map.end())
+            return optional<entry>(it->second);
+        if (auto e = g_app_builder_cache->find(m_ctx->env(), k)) {
+            m_map.insert(mk_pair(k, *e));
+            return e;
+        }
+        return optional<entry>();
+    }
+
+    void save_entry(key const & k, entry const & e) {
+        m_map.insert(mk_pair(k, e));
+        g_app_builder_cache->insert(m_ctx->env(), k, e);
+    }
+
+    static app_builder_arg_plan mk_arg_plan(expr const & mvar) {
+        app_builder_arg_plan r;
+        expr const & type = mlocal_type(mvar);
+        if (!is_idx_metavar(type) || !is_sort(mlocal_type(type)))
+            return r;
+        level l = sort_level(mlocal_type(type));
+        unsigned k = 0;
+        while (is_succ(l)) {
+            l = succ_of(l);
+            k++;
+        }
+        if (!is_idx_metauniv(l))
+            return r;
+        r.m_type_mvar = type;
+        r.m_type_uvar = l;
+        r.m_offset    = k;
+        return r;
+    }
+
+    static list<app_builder_arg_plan> mk_plan(list<expr> const & expl_args) {
+        return map2<app_builder_arg_plan>(expl_args, [](expr const & m) { return mk_arg_plan(m); });
+    }
+
     optional<entry> get_entry(name const & c, unsigned nargs) {
         key k(c, nargs);
         lean_assert(k.check_invariant());
-        auto it = m_map.find(k);
-        if (it == m_map.end()) {
+        optional<entry> r = find_entry(k);
+        if (!r) {
             if (auto d = m_ctx->env().find(c)) {
                 buffer<expr> mvars;
                 buffer<optional<expr>> inst_args;
@@ -149,13 +209,14 @@ struct app_builder::imp {
                 e.m_app       = ::lean::mk_app(mk_constant(c, lvls), mvars);
                 e.m_inst_args = reverse_to_list(inst_args.begin(), inst_args.end());
                 e.m_expl_args = reverse_to_list(mvars.begin() + mvars.size() - nargs, mvars.end());
-                m_map.insert(mk_pair(k, e));
+                e.m_expl_plan = mk_plan(e.m_expl_args);
+                save_entry(k, e);
                 return optional<entry>(e);
             } else {
                 return optional<entry>(); // unknown decl
             }
         } else {
-            return optional<entry>(it->second);
+            return r;
         }
     }
 
@@ -202,8 +263,8 @@ struct app_builder::imp {
     optional<entry> get_entry(name const & c, unsigned mask_sz, bool const * mask) {
         key k(c, to_list(mask, mask+mask_sz));
         lean_assert(k.check_invariant());
-        auto it = m_map.find(k);
-        if (it == m_map.end()) {
+        optional<entry> r = find_entry(k);
+        if (!r) {
             if (auto d = m_ctx->env().find(c)) {
                 buffer<expr> mvars;
                 buffer<optional<expr>> inst_args;
@@ -219,13 +280,14 @@ struct app_builder::imp {
                         expl_args = cons(mvars[i], expl_args);
                 }
                 e.m_expl_args = expl_args;
-                m_map.insert(mk_pair(k, e));
+                e.m_expl_plan = mk_plan(e.m_expl_args);
+                save_entry(k, e);
                 return optional<entry>(e);
             } else {
                 return optional<entry>(); // unknown decl
             }
         } else {
-            return optional<entry>(it->second);
+            return r;
         }
     }
 
@@ -263,6 +325,32 @@ struct app_builder::imp {
         m_ctx->set_next_mvar_idx(e.m_num_emeta);
     }
 
+    /* Assign the explicit argument \c v to \c m. If the plan \c p is applicable, the metavariables
+       in the type of \c m are assigned using the type of \c v, and unification is not used. */
+    bool assign_expl_arg(expr const & m, app_builder_arg_plan const & p, expr const & v) {
+        if (p.m_type_mvar &&
+            !m_ctx->is_mvar_assigned(to_meta_idx(*p.m_type_mvar)) &&
+            !m_ctx->is_uvar_assigned(to_meta_idx(p.m_type_uvar))) {
+            expr v_type = m_ctx->infer(v);
+            expr S      = m_ctx->relaxed_whnf(m_ctx->infer(v_type));
+            if (is_sort(S)) {
+                level l = sort_level(S);
+                unsigned k = 0;
+                while (k < p.m_offset && is_succ(l)) {
+                    l = succ_of(l);
+                    k++;
+                }
+                if (k == p.m_offset) {
+                    m_ctx->update_assignment(p.m_type_uvar, l);
+                    m_ctx->update_assignment(*p.m_type_mvar, v_type);
+                    m_ctx->update_assignment(m, v);
+                    return true;
+                }
+            }
+        }
+        return m_ctx->relaxed_assign(m, v);
+    }
+
     void trace_unify_failure(name const & n, unsigned i, expr const & m, expr const & v) {
         lean_trace("app_builder",
                    trace_fun(n);
@@ -278,13 +366,16 @@ struct app_builder::imp {
         }
         init_ctx_for(*e);
         unsigned i = nargs;
+        list<app_builder_arg_plan> plan = e->m_expl_plan;
         for (auto m : e->m_expl_args) {
             if (i == 0) {
                 trace_failure(c, "too many explicit arguments");
                 throw app_builder_exception();
             }
             --i;
-            if (!m_ctx->relaxed_assign(m, args[i])) {
+            app_builder_arg_plan const & p = head(plan);
+            plan = tail(plan);
+            if (!assign_expl_arg(m, p, args[i])) {
                 trace_unify_failure(c, i, m, args[i]);
                 throw app_builder_exception();
             }
@@ -320,16 +411,18 @@ struct app_builder::imp {
         unsigned i    = mask_sz;
         unsigned j    = nargs;
         list<expr> it = e->m_expl_args;
+        list<app_builder_arg_plan> plan = e->m_expl_plan;
         while (i > 0) {
             --i;
             if (mask[i]) {
                 --j;
                 expr const & m = head(it);
-                if (!m_ctx->relaxed_assign(m, args[j])) {
+                if (!assign_expl_arg(m, head(plan), args[j])) {
                     trace_unify_failure(c, j, m, args[j]);
                     throw app_builder_exception();
                 }
-                it = tail(it);
+                it   = tail(it);
+                plan = tail(plan);
             }
         }
         if (!check_all_assigned(*e)) {
@@ -921,7 +1014,10 @@ void app_builder::set_local_instances(list<expr> const & insts) {
     m_ptr->m_ctx->set_local_instances(insts);
 }
 void initialize_app_builder() {
+    g_app_builder_cache = new app_builder_cache();
     register_trace_class("app_builder");
 }
-void finalize_app_builder() {}
+void finalize_app_builder() {
+    delete g_app_builder_cache;
+}
 }
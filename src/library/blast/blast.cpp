@@ -676,7 +676,7 @@ public:
         m_is_relation_pred(mk_is_relation_pred(env)),
         m_tmp_ctx(mk_tmp_type_context()),
         m_app_builder(*m_tmp_ctx),
-        m_fun_info_manager(*m_tmp_ctx),
+        m_fun_info_manager(*m_tmp_ctx, true),
         m_congr_lemma_manager(m_app_builder, m_fun_info_manager),
         m_abstract_expr_manager(m_congr_lemma_manager),
         m_proof_irrel_expr_manager(m_fun_info_manager),
@@ -6,6 +6,7 @@ Author: Leonardo de Moura
 */
 #include <algorithm>
 #include "util/interrupt.h"
+#include "util/stats.h"
 #include "util/sexpr/option_declarations.h"
 #include "library/constants.h"
 #include "library/idx_metavar.h"
@@ -36,6 +37,7 @@ namespace blast {
 #define lean_trace_debug_ematch(Code) lean_trace(name({"debug", "blast", "ematch"}), Code)
 
 static name * g_blast_ematch_max_instances = nullptr;
+static stats_id g_ematch_instances_stats   = 0;
 
 unsigned get_blast_ematch_max_instances(options const & o) {
     return o.get_unsigned(*g_blast_ematch_max_instances, LEAN_DEFAULT_BLAST_EMATCH_MAX_INSTANCES);
@@ -240,6 +242,8 @@ void initialize_ematch() {
     register_trace_class(name{"blast", "ematch"});
     register_trace_class(name{"blast", "event", "ematch"});
     register_trace_class(name{"debug", "blast", "ematch"});
+    g_ematch_instances_stats = register_stats_counter(name{"blast", "ematch", "instances"},
+                                                      "number of instances created by ematching");
 
     g_blast_ematch_max_instances = new name{"blast", "ematch", "max_instances"};
 
@@ -617,6 +621,7 @@ struct ematch_fn {
             trace_action("ematch");
         }
         lean_trace_ematch(tout() << "instance [" << lemma.m_expr << "]: " << new_inst << "\n";);
+        stats_inc(g_ematch_instances_stats);
         m_new_instances = true;
         expr new_proof = m_ctx->instantiate_uvars_mvars(lemma.m_proof);
         curr_state().mk_hypothesis(new_inst, new_proof);
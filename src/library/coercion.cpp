@@ -4,15 +4,24 @@ Released under Apache 2.0 license as described in the file LICENSE.
 
 Author: Leonardo de Moura
 */
+#include <algorithm>
 #include <utility>
 #include <string>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <limits>
 #include "util/rb_map.h"
+#include "util/list_fn.h"
+#include "util/name_set.h"
 #include "util/sstream.h"
+#include "util/thread.h"
+#include "util/fresh_name.h"
 #include "kernel/instantiate.h"
+#include "kernel/abstract.h"
+#include "kernel/expr_sets.h"
 #include "library/tc_multigraph.h"
 #include "library/coercion.h"
-#include "library/reducible.h"
-#include "library/protected.h"
 #include "library/module.h"
 #include "library/kernel_serializer.h"
 #include "library/scoped_ext.h"
@@ -34,16 +43,52 @@ struct coercion_entry {
         m_from(from), m_coe(coe), m_num_args(num), m_to(to) {}
 };
 
+/** \brief A path C >-> ... >-> D in the coercion graph. The timestamp of a path is the time its first
+    coercion of the graph was added. That is, a composition is as recent as the coercion it starts with,
+    and the coercions in the rest of the path do not change its position when their namespaces are opened. */
+struct coercion_path {
+    name       m_to;
+    unsigned   m_timestamp;
+    unsigned   m_length;
+    list<name> m_edges;
+    list<name> m_classes; // classes visited by the path (the source is not included)
+    coercion_path(name const & to, unsigned ts, unsigned len, list<name> const & edges, list<name> const & classes):
+        m_to(to), m_timestamp(ts), m_length(len), m_edges(edges), m_classes(classes) {}
+};
+
+/** \brief Coercion paths that were already computed for a given coercion graph.
+
+    The entry for a class C contains the paths starting at C. Paths may also use coercions
+    declared in namespaces that are not open (hidden coercions), but they must contain at least one
+    coercion of the graph. That is, when a namespace is opened, the compositions of its coercions with
+    the coercions that were declared in other namespaces become available too. */
+struct coercion_path_cache {
+    mutex                                                                                     m_mutex;
+    bool                                                                                      m_hidden_initialized;
+    name_map<list<pair<name, name>>>                                                          m_hidden; // class -> (coe, to)
+    name_map<unsigned>                                                                        m_hidden_num_args;
+    std::unordered_map<name, std::shared_ptr<std::vector<coercion_path>>, name_hash, name_eq> m_paths;
+    coercion_path_cache():m_hidden_initialized(false) {}
+};
+
+/** \brief The coercion graph only contains the coercions declared by users.
+    Compositions C >-> D >-> E are computed on demand by #get_coercion_paths. */
 struct coercion_state {
-    tc_multigraph                   m_graph;
-    name_map<pair<name, unsigned>>  m_coercions; // map coercion -> (from-class, num-args)
+    tc_multigraph                        m_graph;
+    name_map<pair<name, unsigned>>       m_coercions; // map coercion -> (from-class, num-args)
+    name_map<unsigned>                   m_timestamps; // map coercion -> last time it was added
+    unsigned                             m_next_timestamp;
+    std::shared_ptr<coercion_path_cache> m_cache;
 
     void add1(environment const & env, name const & from, name const & coe, unsigned num, name const & to) {
         m_coercions.insert(coe, mk_pair(from, num));
+        m_timestamps.insert(coe, m_next_timestamp);
+        m_next_timestamp++;
         m_graph.add1(env, from, coe, to);
+        m_cache = std::make_shared<coercion_path_cache>();
     }
 
-    coercion_state():m_graph("coercion") {}
+    coercion_state():m_graph("coercion"), m_next_timestamp(0), m_cache(std::make_shared<coercion_path_cache>()) {}
 };
 
 static name * g_class_name = nullptr;
@@ -106,9 +151,149 @@ bool has_coercions_to_fun(environment const & env) {
     return !is_nil(ext.m_graph.get_predecessors(*g_fun));
 }
 
+/** \brief Initialize the hidden coercions of \c cache, i.e., the coercions declared in namespaces
+    that are not open.
+    \pre The cache mutex is locked. */
+static void init_hidden_coercions(environment const & env, coercion_state const & ext, coercion_path_cache & cache) {
+    if (cache.m_hidden_initialized)
+        return;
+    cache.m_hidden_initialized = true;
+    coercion_ext::for_each_entry(env, [&](coercion_entry const & e) {
+            if (ext.m_coercions.contains(e.m_coe) || cache.m_hidden_num_args.contains(e.m_coe))
+                return;
+            list<pair<name, name>> const * succs = cache.m_hidden.find(e.m_from);
+            cache.m_hidden.insert(e.m_from, cons(mk_pair(e.m_coe, e.m_to), succs ? *succs : list<pair<name, name>>()));
+            cache.m_hidden_num_args.insert(e.m_coe, e.m_num_args);
+        });
+}
+
+#ifndef LEAN_MAX_COERCION_PATHS
+#define LEAN_MAX_COERCION_PATHS 8
+#endif
+
+/** \brief Functional object for computing the coercion paths starting at a given class.
+    The paths starting at each intermediate class are memoized, and at most LEAN_MAX_COERCION_PATHS
+    paths are kept for each target class. So, the cost is polynomial in the size of the coercion graph. */
+class coercion_paths_fn {
+    typedef std::vector<coercion_path> paths;
+    typedef std::unordered_map<name, paths, name_hash, name_eq> memo;
+    coercion_state const &      m_ext;
+    coercion_path_cache const & m_cache;
+    name                        m_source;
+    memo                        m_memo[2];
+    /* classes being visited, and their depth in the search */
+    name_map<unsigned>          m_visiting;
+
+    /** \brief Sort \c r (most recent paths first, longer paths first when their timestamps are equal),
+        and keep at most LEAN_MAX_COERCION_PATHS paths for each target class. */
+    static void prune(paths & r) {
+        std::stable_sort(r.begin(), r.end(), [](coercion_path const & p1, coercion_path const & p2) {
+                return p1.m_timestamp > p2.m_timestamp ||
+                    (p1.m_timestamp == p2.m_timestamp && p1.m_length > p2.m_length);
+            });
+        name_map<unsigned> num_paths;
+        unsigned j = 0;
+        for (unsigned i = 0; i < r.size(); i++) {
+            unsigned const * n = num_paths.find(r[i].m_to);
+            unsigned k = n ? *n : 0;
+            if (k < LEAN_MAX_COERCION_PATHS) {
+                num_paths.insert(r[i].m_to, k + 1);
+                if (i != j)
+                    r[j] = r[i];
+                j++;
+            }
+        }
+        r.erase(r.begin() + j, r.end());
+    }
+
+    /** \brief Return the paths starting at \c u. If \c needs_visible is true, then the paths must contain at
+        least one coercion of the graph.
+        The search is cut at the classes being visited. \c min_depth is set to the minimum of its value and
+        the depth of the classes where it was cut. The result depends on the classes being visited only if
+        it was cut at a class visited before \c u, and it is only memoized otherwise. */
+    paths visit(name const & u, bool needs_visible, unsigned & min_depth) {
+        auto it = m_memo[needs_visible].find(u);
+        if (it != m_memo[needs_visible].end())
+            return it->second;
+        paths r;
+        unsigned depth       = m_visiting.size();
+        unsigned min_depth_u = std::numeric_limits<unsigned>::max();
+        m_visiting.insert(u, depth);
+        auto add_edge = [&](name const & coe, name const & v, bool visible) {
+            if (v == m_source)
+                return;
+            unsigned ts = 0;
+            if (visible) {
+                if (auto t = m_ext.m_timestamps.find(coe))
+                    ts = *t;
+            }
+            if (visible || !needs_visible)
+                r.emplace_back(v, ts, 1, to_list(coe), to_list(v));
+            if (unsigned const * d = m_visiting.find(v)) {
+                min_depth_u = std::min(min_depth_u, *d);
+                return;
+            }
+            for (coercion_path const & p : visit(v, needs_visible && !visible, min_depth_u)) {
+                if (std::find(p.m_classes.begin(), p.m_classes.end(), u) != p.m_classes.end())
+                    continue;
+                r.emplace_back(p.m_to, visible ? ts : p.m_timestamp, p.m_length + 1,
+                               cons(coe, p.m_edges), cons(v, p.m_classes));
+            }
+        };
+        for (pair<name, name> const & coe_to : m_ext.m_graph.get_successors(u))
+            add_edge(coe_to.first, coe_to.second, true);
+        if (list<pair<name, name>> const * succs = m_cache.m_hidden.find(u)) {
+            for (pair<name, name> const & coe_to : *succs)
+                add_edge(coe_to.first, coe_to.second, false);
+        }
+        m_visiting.erase(u);
+        prune(r);
+        min_depth = std::min(min_depth, min_depth_u);
+        if (min_depth_u >= depth)
+            m_memo[needs_visible].insert(mk_pair(u, r));
+        return r;
+    }
+
+public:
+    coercion_paths_fn(coercion_state const & ext, coercion_path_cache const & cache, name const & C):
+        m_ext(ext), m_cache(cache), m_source(C) {}
+
+    paths operator()() {
+        unsigned min_depth = std::numeric_limits<unsigned>::max();
+        return visit(m_source, true, min_depth);
+    }
+};
+
+/** \brief Return the coercion paths starting at \c C. The most recent paths occur first, and a composition
+    occurs before the paths it extends. This is the order the coercions would have if the compositions
+    were added to the coercion graph when their first coercion is added.
+    The paths are cached until a new coercion is added to the graph. */
+static std::shared_ptr<std::vector<coercion_path>> get_coercion_paths(environment const & env, coercion_state const & ext,
+                                                                      name const & C) {
+    coercion_path_cache & cache = *ext.m_cache;
+    lock_guard<mutex> lock(cache.m_mutex);
+    auto it = cache.m_paths.find(C);
+    if (it != cache.m_paths.end())
+        return it->second;
+    init_hidden_coercions(env, ext, cache);
+    auto r = std::make_shared<std::vector<coercion_path>>(coercion_paths_fn(ext, cache, C)());
+    cache.m_paths.insert(mk_pair(C, r));
+    return r;
+}
+
+/** \brief Return the number of arguments of the class of the coercion \c coe */
+static optional<unsigned> get_coercion_num_args(coercion_state const & ext, name const & coe) {
+    if (auto it = ext.m_coercions.find(coe))
+        return optional<unsigned>(it->second);
+    lock_guard<mutex> lock(ext.m_cache->m_mutex);
+    if (auto it = ext.m_cache->m_hidden_num_args.find(coe))
+        return optional<unsigned>(*it);
+    return optional<unsigned>();
+}
+
 bool has_coercions_from(environment const & env, name const & C) {
     coercion_state const & ext = coercion_ext::get_state(env);
-    return !is_nil(ext.m_graph.get_successors(C));
+    return !is_nil(ext.m_graph.get_successors(C)) || !get_coercion_paths(env, ext, C)->empty();
 }
 
 bool has_coercions_from(environment const & env, expr const & C) {
@@ -116,41 +301,92 @@ bool has_coercions_from(environment const & env, expr const & C) {
     if (!is_constant(C_fn))
         return false;
     coercion_state const & ext = coercion_ext::get_state(env);
-    for (pair<name, name> const & coe_to : ext.m_graph.get_successors(const_name(C_fn))) {
-        name const & coe = coe_to.first;
-        if (auto it = ext.m_coercions.find(coe)) {
-            if (it->second == get_app_num_args(C))
+    for (coercion_path const & path : *get_coercion_paths(env, ext, const_name(C_fn))) {
+        if (auto n = get_coercion_num_args(ext, head(path.m_edges))) {
+            if (*n == get_app_num_args(C))
                 return true;
         }
     }
     return false;
 }
 
-static list<expr> get_coercions_core(environment const & env, expr const & C, name const & D) {
-    buffer<expr> args;
-    expr const & C_fn = get_app_rev_args(C, args);
+/** \brief Return the coercion (C_fn.{ls} args) >-> D for the coercion \c coe. */
+static optional<expr> mk_coercion(environment const & env, coercion_state const & ext,
+                                  name const & coe, expr const & C_fn, buffer<expr> const & args) {
+    optional<unsigned> n = get_coercion_num_args(ext, coe);
+    if (!n || *n != args.size())
+        return none_expr();
+    declaration const & coe_decl = env.get(coe);
+    if (coe_decl.get_num_univ_params() != length(const_levels(C_fn)))
+        return none_expr();
+    return some_expr(mk_app(mk_constant(coe, const_levels(C_fn)), args));
+}
+
+/** \brief Return the composition of the coercions in \c path for the type \c C.
+    The result is of the form (fun (x : C), coe_n ... (coe_1 x)), and its type is stored in \c type.
+    The type produced by each coercion is obtained by instantiating its declared type,
+    i.e., no type inference is needed. */
+static optional<expr> mk_coercion_composition(environment const & env, coercion_state const & ext,
+                                              expr const & C, list<name> const & path, expr & type) {
+    expr x = mk_local(mk_fresh_name(), "x", C, binder_info());
+    expr e = x;
+    expr T = C;
+    optional<expr> f;
+    for (name const & coe : path) {
+        buffer<expr> args;
+        expr T_fn = get_app_args(T, args);
+        if (!is_constant(T_fn))
+            return none_expr();
+        f = mk_coercion(env, ext, coe, T_fn, args);
+        if (!f)
+            return none_expr();
+        expr f_type = instantiate_type_univ_params(env.get(coe), const_levels(T_fn));
+        for (expr const & arg : args) {
+            if (!is_pi(f_type))
+                return none_expr();
+            f_type = instantiate(binding_body(f_type), arg);
+        }
+        if (!is_pi(f_type))
+            return none_expr();
+        T = instantiate(binding_body(f_type), e);
+        e = mk_app(*f, e);
+    }
+    type = Pi(x, T);
+    if (length(path) == 1)
+        return f;
+    else
+        return some_expr(Fun(x, e));
+}
+
+/** \brief Store in \c r the coercions from \c C to \c D (to any class if \c D is none).
+    The most recent coercions occur first. A coercion is skipped if its type is equal to the type of
+    a more recent one. This is consistent with the coercion graph that discards coercions with
+    definitionally equal types (e.g., the paths A >-> B >-> D and A >-> D are the same coercion
+    for a structure A extending B and D, and B extending D). */
+static void get_coercions_core(environment const & env, expr const & C, optional<name> const & D, buffer<expr> & r) {
+    expr const & C_fn = get_app_fn(C);
     if (!is_constant(C_fn))
-        return list<expr>();
+        return;
     coercion_state const & ext = coercion_ext::get_state(env);
-    buffer<expr> r;
-    for (pair<name, name> const & coe_to : ext.m_graph.get_successors(const_name(C_fn))) {
-        name const & coe = coe_to.first;
-        name const & to  = coe_to.second;
-        if (to != D)
+    expr_struct_set types;
+    for (coercion_path const & path : *get_coercion_paths(env, ext, const_name(C_fn))) {
+        if (D && path.m_to != *D)
             continue;
-        if (auto it = ext.m_coercions.find(coe)) {
-            if (it->second != args.size())
+        expr type;
+        if (auto f = mk_coercion_composition(env, ext, C, path.m_edges, type)) {
+            if (types.find(type) != types.end())
                 continue;
+            types.insert(type);
+            r.push_back(*f);
         }
-        declaration const & coe_decl = env.get(coe);
-        if (coe_decl.get_num_univ_params() != length(const_levels(C_fn)))
-            continue;
-        expr f = mk_constant(coe, const_levels(C_fn));
-        r.push_back(mk_rev_app(f, args.size(), args.data()));
     }
-    return to_list(r);
 }
 
+static list<expr> get_coercions_core(environment const & env, expr const & C, name const & D) {
+    buffer<expr> r;
+    get_coercions_core(env, C, optional<name>(D), r);
+    return to_list(r);
+}
 
 list<expr> get_coercions(environment const & env, expr const & C, name const & D) {
     return get_coercions_core(env, C, D);
@@ -165,26 +401,16 @@ list<expr> get_coercions_to_fun(environment const & env, expr const & C) {
 }
 
 bool get_coercions_from(environment const & env, expr const & C, buffer<expr> & result) {
-    buffer<expr> args;
-    expr const & C_fn = get_app_rev_args(C, args);
-    if (!is_constant(C_fn))
-        return false;
-    coercion_state const & ext = coercion_ext::get_state(env);
-    bool r = false;
-    for (pair<name, name> const & coe_to : ext.m_graph.get_successors(const_name(C_fn))) {
-        name const & coe = coe_to.first;
-        if (auto it = ext.m_coercions.find(coe)) {
-            if (it->second != args.size())
-                continue;
-        }
-        declaration const & coe_decl = env.get(coe);
-        if (coe_decl.get_num_univ_params() != length(const_levels(C_fn)))
-            continue;
-        expr f = mk_constant(coe, const_levels(C_fn));
-        result.push_back(mk_rev_app(f, args.size(), args.data()));
-        r = true;
-    }
-    return r;
+    unsigned old_sz = result.size();
+    get_coercions_core(env, C, optional<name>(), result);
+    return result.size() > old_sz;
+}
+
+expr mk_coercion_app(expr const & coe, expr const & a) {
+    if (is_lambda(coe))
+        return instantiate(binding_body(coe), a);
+    else
+        return mk_app(coe, a);
 }
 
 void for_each_coercion_user(environment const & env, coercion_user_fn const & f) {
@@ -276,37 +502,10 @@ static bool is_user_class(name const & cls) {
     return cls != *g_fun && cls != *g_sort;
 }
 
-static unsigned get_num_args(environment const & env, tc_edge const & new_coe) {
-    declaration const & d = env.get(new_coe.m_cnst);
-    unsigned num = 0;
-    buffer<expr> args;
-    expr t = d.get_type();
-    while (true) {
-        if (!is_pi(t))
-            return num;
-        expr fn = get_app_fn(binding_domain(t));
-        if (is_constant(fn) && const_name(fn) == new_coe.m_from)
-            return num;
-        t = binding_body(t);
-        num++;
-    }
-}
-
 static environment add_coercion_core(environment const & env,
                                      name const & from, name const & coe, unsigned num_args, name const & to,
                                      name const & ns, bool persistent) {
-    coercion_state st = coercion_ext::get_state(env);
-    pair<environment, list<tc_edge>> new_env_coes = st.m_graph.add(env, from, coe, to);
-    environment new_env = new_env_coes.first;
-    new_env = coercion_ext::add_entry(new_env, get_dummy_ios(), coercion_entry(from, coe, num_args, to), ns, persistent);
-    for (tc_edge const & new_coe : new_env_coes.second) {
-        unsigned nargs = get_num_args(new_env, new_coe);
-        new_env = coercion_ext::add_entry(new_env, get_dummy_ios(),
-                                          coercion_entry(new_coe.m_from, new_coe.m_cnst, nargs, new_coe.m_to), ns, persistent);
-        new_env = set_reducible(new_env, new_coe.m_cnst, reducible_status::Reducible, ns, persistent);
-        new_env = add_protected(new_env, new_coe.m_cnst);
-    }
-    return new_env;
+    return coercion_ext::add_entry(env, get_dummy_ios(), coercion_entry(from, coe, num_args, to), ns, persistent);
 }
 
 static environment add_coercion(environment const & env, name const & f, name const & C, name const & ns, bool persistent) {
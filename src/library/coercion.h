@@ -53,10 +53,16 @@ bool has_coercions_to_fun(environment const & env);
    \brief Return a coercion (if it exists) from (C_name.{l1 lk} t_1 ... t_n) to the class named D.
    The coercion is a unary function that takes a term of type (C_name.{l1 lk} t_1 ... t_n) and returns
    and element of type (D.{L_1  L_o} s_1 ... s_m)
+
+   \remark If there is no coercion from C_name to D, then a composition of coercions along a shortest
+   path from C_name to D is returned.
 */
 list<expr> get_coercions(environment const & env, expr const & C, name const & D);
 list<expr> get_coercions_to_sort(environment const & env, expr const & C);
 list<expr> get_coercions_to_fun(environment const & env, expr const & C);
+/** \brief Apply the coercion \c coe returned by one of the functions above to \c a.
+    Compositions of coercions are lambda-expressions, and they are beta-reduced here. */
+expr mk_coercion_app(expr const & coe, expr const & a);
 /**
    \brief Return all coercions C >-> D for the type C of the form (C_name.{l1 ... lk} t_1 ... t_n)
    The coercions are stored in result.
@@ -0,0 +1,178 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include "util/interrupt.h"
+#include "util/fresh_name.h"
+#include "util/sexpr/option_declarations.h"
+#include "kernel/expr_maps.h"
+#include "kernel/abstract.h"
+#include "kernel/type_checker.h"
+#include "library/max_sharing.h"
+#include "library/compress_proof.h"
+
+#ifndef LEAN_DEFAULT_COMPRESS_PROOFS
+#define LEAN_DEFAULT_COMPRESS_PROOFS false
+#endif
+
+#ifndef LEAN_DEFAULT_COMPRESS_PROOFS_MIN_WEIGHT
+#define LEAN_DEFAULT_COMPRESS_PROOFS_MIN_WEIGHT 16
+#endif
+
+namespace lean {
+static name * g_compress_proofs            = nullptr;
+static name * g_compress_proofs_min_weight = nullptr;
+static name * g_compress_prefix            = nullptr;
+
+bool get_compress_proofs(options const & o) {
+    return o.get_bool(*g_compress_proofs, LEAN_DEFAULT_COMPRESS_PROOFS);
+}
+
+static unsigned get_compress_proofs_min_weight(options const & o) {
+    return o.get_unsigned(*g_compress_proofs_min_weight, LEAN_DEFAULT_COMPRESS_PROOFS_MIN_WEIGHT);
+}
+
+class compress_proof_fn {
+    type_checker       m_tc;
+    unsigned           m_min_weight;
+    /* number of occurrences of shared subterms */
+    expr_map<unsigned> m_num_occs;
+    expr_map<expr>     m_cache;
+    /* m_locals[i] is the local constant abbreviating m_values[i].
+       Remark: m_values[i] may only contain m_locals[j] for j < i. */
+    buffer<expr>       m_locals;
+    buffer<expr>       m_values;
+
+    bool is_candidate(expr const & e) const {
+        return get_weight(e) >= m_min_weight && !has_free_vars(e) && !has_local(e) && !has_metavar(e);
+    }
+
+    void count(expr const & e) {
+        if (get_weight(e) < m_min_weight)
+            return;
+        if (is_shared(e)) {
+            unsigned & n = m_num_occs[e];
+            n++;
+            if (n > 1)
+                return; // children have already been visited
+        }
+        check_system("compress proof");
+        switch (e.kind()) {
+        case expr_kind::Var:   case expr_kind::Sort: case expr_kind::Constant:
+        case expr_kind::Local: case expr_kind::Meta:
+            break;
+        case expr_kind::App:
+            count(app_fn(e)); count(app_arg(e));
+            break;
+        case expr_kind::Lambda: case expr_kind::Pi:
+            count(binding_domain(e)); count(binding_body(e));
+            break;
+        case expr_kind::Let:
+            count(let_type(e)); count(let_value(e)); count(let_body(e));
+            break;
+        case expr_kind::Macro:
+            for (unsigned i = 0; i < macro_num_args(e); i++)
+                count(macro_arg(e, i));
+            break;
+        }
+    }
+
+    bool occurs_more_than_once(expr const & e) const {
+        auto it = m_num_occs.find(e);
+        return it != m_num_occs.end() && it->second > 1;
+    }
+
+    expr visit_children(expr const & e) {
+        switch (e.kind()) {
+        case expr_kind::Var:   case expr_kind::Sort: case expr_kind::Constant:
+        case expr_kind::Local: case expr_kind::Meta:
+            return e;
+        case expr_kind::App:
+            return update_app(e, visit(app_fn(e)), visit(app_arg(e)));
+        case expr_kind::Lambda: case expr_kind::Pi:
+            return update_binding(e, visit(binding_domain(e)), visit(binding_body(e)));
+        case expr_kind::Let:
+            return update_let(e, visit(let_type(e)), visit(let_value(e)), visit(let_body(e)));
+        case expr_kind::Macro: {
+            buffer<expr> new_args;
+            for (unsigned i = 0; i < macro_num_args(e); i++)
+                new_args.push_back(visit(macro_arg(e, i)));
+            return update_macro(e, new_args.size(), new_args.data());
+        }}
+        lean_unreachable();
+    }
+
+    expr visit(expr const & e) {
+        if (get_weight(e) < m_min_weight)
+            return e;
+        bool shared = is_shared(e);
+        if (shared) {
+            auto it = m_cache.find(e);
+            if (it != m_cache.end())
+                return it->second;
+        }
+        expr r = visit_children(e);
+        if (is_candidate(e) && occurs_more_than_once(e)) {
+            expr type = m_tc.infer(e).first;
+            /* We only abbreviate proofs. The kernel type checks the body of the resulting
+               let-expressions using opaque local constants, and this is only sound for proofs. */
+            if (m_tc.is_prop(type).first) {
+                expr l = mk_local(mk_fresh_name(), g_compress_prefix->append_after(m_locals.size() + 1), type, binder_info());
+                m_locals.push_back(l);
+                m_values.push_back(r);
+                r = l;
+            }
+        }
+        if (shared)
+            m_cache.insert(mk_pair(e, r));
+        return r;
+    }
+
+public:
+    compress_proof_fn(environment const & env, unsigned min_weight):
+        m_tc(env), m_min_weight(min_weight) {}
+
+    expr operator()(expr const & e) {
+        expr s = max_sharing(e);
+        count(s);
+        expr r = visit(s);
+        if (m_locals.empty())
+            return e;
+        r = abstract_locals(r, m_locals.size(), m_locals.data());
+        unsigned i = m_locals.size();
+        while (i > 0) {
+            --i;
+            expr const & l = m_locals[i];
+            r = mk_let(local_pp_name(l), mlocal_type(l), abstract_locals(m_values[i], i, m_locals.data()), r);
+        }
+        return r;
+    }
+};
+
+expr compress_proof(environment const & env, expr const & e, unsigned min_weight) {
+    return compress_proof_fn(env, min_weight)(e);
+}
+
+expr compress_proof(environment const & env, expr const & e, options const & o) {
+    return compress_proof(env, e, get_compress_proofs_min_weight(o));
+}
+
+void initialize_compress_proof() {
+    g_compress_proofs            = new name{"compress_proofs"};
+    g_compress_proofs_min_weight = new name{"compress_proofs", "min_weight"};
+    g_compress_prefix            = new name("_h");
+    register_bool_option(*g_compress_proofs, LEAN_DEFAULT_COMPRESS_PROOFS,
+                         "(kernel) abbreviate repeated subterms in proofs using let-expressions "
+                         "before type checking and storing them");
+    register_unsigned_option(*g_compress_proofs_min_weight, LEAN_DEFAULT_COMPRESS_PROOFS_MIN_WEIGHT,
+                             "(kernel) minimal weight of subterms abbreviated by compress_proofs");
+}
+
+void finalize_compress_proof() {
+    delete g_compress_prefix;
+    delete g_compress_proofs_min_weight;
+    delete g_compress_proofs;
+}
+}
@@ -0,0 +1,28 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include "util/sexpr/options.h"
+#include "kernel/environment.h"
+
+namespace lean {
+/**
+   \brief Abbreviate closed subterms that occur more than once in \c e using let-expressions.
+   The let-expressions are placed at the beginning of the result, and the result is
+   definitionally equal to \c e (by zeta-reduction).
+
+   Only subterms with weight (see \c get_weight) at least \c min_weight are abbreviated.
+*/
+expr compress_proof(environment const & env, expr const & e, unsigned min_weight);
+/** \brief Similar to the previous procedure, but uses the minimal weight stored in the given options. */
+expr compress_proof(environment const & env, expr const & e, options const & o);
+
+/** \brief Return true if proofs should be compressed (see \c compress_proof) before being type checked and stored. */
+bool get_compress_proofs(options const & o);
+
+void initialize_compress_proof();
+void finalize_compress_proof();
+}
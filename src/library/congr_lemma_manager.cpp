@@ -13,9 +13,23 @@ Author: Leonardo de Moura
 #include "library/replace_visitor.h"
 #include "library/relation_manager.h"
 #include "library/expr_unsigned_map.h"
+#include "library/shared_environment_cache.h"
 #include "library/congr_lemma_manager.h"
 
 namespace lean {
+/* Caches for congruence lemmas of closed functions shared by all threads
+   (see fun_info_manager::use_shared_cache). */
+struct congr_lemma_shared_caches {
+    typedef shared_environment_cache<expr_unsigned, congr_lemma, expr_unsigned_hash_fn, expr_unsigned_eq_fn> cache;
+    cache m_simp_cache;
+    cache m_simp_cache_spec;
+    cache m_cache;
+    cache m_cache_spec;
+    cache m_hcache;
+};
+
+static congr_lemma_shared_caches * g_shared_caches = nullptr;
+
 bool congr_lemma::all_eq_kind() const {
     return std::all_of(m_arg_kinds.begin(), m_arg_kinds.end(),
                        [](congr_arg_kind k) { return k == congr_arg_kind::Eq; });
@@ -27,6 +41,7 @@ struct congr_lemma_manager::imp {
     type_context &     m_ctx;
     typedef expr_unsigned key;
     typedef expr_unsigned_map<result>  cache;
+    typedef congr_lemma_shared_caches::cache shared_cache;
     cache                m_simp_cache;
     cache                m_simp_cache_spec;
     cache                m_cache;
@@ -35,6 +50,23 @@ struct congr_lemma_manager::imp {
     cache                m_rel_cache[2];
     relation_info_getter m_relation_info_getter;
 
+    /* Return the cached result for \c k. The cache \c sc is used for closed functions, and \c c otherwise. */
+    optional<result> find_cached(cache const & c, shared_cache & sc, key const & k) {
+        if (m_fmanager.use_shared_cache(k.m_expr))
+            return sc.find(m_ctx.env(), k);
+        auto it = c.find(k);
+        if (it != c.end())
+            return optional<result>(it->second);
+        return optional<result>();
+    }
+
+    void save_cached(cache & c, shared_cache & sc, key const & k, result const & r) {
+        if (m_fmanager.use_shared_cache(k.m_expr))
+            sc.insert(m_ctx.env(), k, r);
+        else
+            c.insert(mk_pair(k, r));
+    }
+
     expr infer(expr const & e) { return m_ctx.infer(e); }
     expr whnf(expr const & e) { return m_ctx.whnf(e); }
     expr relaxed_whnf(expr const & e) { return m_ctx.relaxed_whnf(e); }
@@ -329,9 +361,8 @@ struct congr_lemma_manager::imp {
     }
 
     optional<result> mk_congr_simp(expr const & fn, unsigned nargs, fun_info const & finfo) {
-        auto r = m_simp_cache.find(key(fn, nargs));
-        if (r != m_simp_cache.end())
-            return optional<result>(r->second);
+        if (auto r = find_cached(m_simp_cache, g_shared_caches->m_simp_cache, key(fn, nargs)))
+            return r;
         list<unsigned> const & result_deps = finfo.get_result_dependencies();
         buffer<congr_arg_kind> kinds;
         buffer<param_info>     pinfos;
@@ -365,7 +396,7 @@ struct congr_lemma_manager::imp {
         }
         auto new_r = mk_congr_simp(fn, pinfos, kinds);
         if (new_r) {
-            m_simp_cache.insert(mk_pair(key(fn, nargs), *new_r));
+            save_cached(m_simp_cache, g_shared_caches->m_simp_cache, key(fn, nargs), *new_r);
             return new_r;
         } else if (has_cast(kinds)) {
             // remove casts and try again
@@ -375,7 +406,7 @@ struct congr_lemma_manager::imp {
             }
             auto new_r = mk_congr_simp(fn, pinfos, kinds);
             if (new_r) {
-                m_simp_cache.insert(mk_pair(key(fn, nargs), *new_r));
+                save_cached(m_simp_cache, g_shared_caches->m_simp_cache, key(fn, nargs), *new_r);
                 return new_r;
             } else {
                 return new_r;
@@ -386,9 +417,8 @@ struct congr_lemma_manager::imp {
     }
 
     optional<result> mk_congr(expr const & fn, unsigned nargs, fun_info const & finfo) {
-        auto r = m_cache.find(key(fn, nargs));
-        if (r != m_cache.end())
-            return optional<result>(r->second);
+        if (auto r = find_cached(m_cache, g_shared_caches->m_cache, key(fn, nargs)))
+            return r;
         optional<result> simp_lemma = mk_congr_simp(fn, nargs);
         if (!simp_lemma)
             return optional<result>();
@@ -411,12 +441,12 @@ struct congr_lemma_manager::imp {
                 has_cast = true;
         }
         if (!has_cast) {
-            m_cache.insert(mk_pair(key(fn, nargs), *simp_lemma));
+            save_cached(m_cache, g_shared_caches->m_cache, key(fn, nargs), *simp_lemma);
             return simp_lemma; // simp_lemma will be identical to regular congr lemma
         }
         auto new_r = mk_congr(fn, simp_lemma, pinfos, kinds);
         if (new_r)
-            m_cache.insert(mk_pair(key(fn, nargs), *new_r));
+            save_cached(m_cache, g_shared_caches->m_cache, key(fn, nargs), *new_r);
         return new_r;
     }
 
@@ -539,14 +569,13 @@ public:
         expr g; unsigned prefix_sz, num_rest_args;
         pre_specialize(a, g, prefix_sz, num_rest_args);
         key k(g, num_rest_args);
-        auto it = m_simp_cache_spec.find(k);
-        if (it != m_simp_cache_spec.end())
-            return optional<result>(it->second);
+        if (auto r = find_cached(m_simp_cache_spec, g_shared_caches->m_simp_cache_spec, k))
+            return r;
         auto r = mk_congr_simp(g, num_rest_args);
         if (!r)
             return optional<result>();
         result new_r = mk_specialize_result(*r, prefix_sz);
-        m_simp_cache_spec.insert(mk_pair(k, new_r));
+        save_cached(m_simp_cache_spec, g_shared_caches->m_simp_cache_spec, k, new_r);
         return optional<result>(new_r);
     }
 
@@ -565,25 +594,23 @@ public:
         expr g; unsigned prefix_sz, num_rest_args;
         pre_specialize(a, g, prefix_sz, num_rest_args);
         key k(g, num_rest_args);
-        auto it = m_cache_spec.find(k);
-        if (it != m_cache_spec.end())
-            return optional<result>(it->second);
+        if (auto r = find_cached(m_cache_spec, g_shared_caches->m_cache_spec, k))
+            return r;
         auto r = mk_congr(g, num_rest_args);
         if (!r) {
             return optional<result>();
         }
         result new_r = mk_specialize_result(*r, prefix_sz);
-        m_cache_spec.insert(mk_pair(k, new_r));
+        save_cached(m_cache_spec, g_shared_caches->m_cache_spec, k, new_r);
         return optional<result>(new_r);
     }
 
     optional<result> mk_hcongr(expr const & fn, unsigned nargs) {
-        auto r = m_hcache.find(key(fn, nargs));
-        if (r != m_hcache.end())
-            return optional<result>(r->second);
+        if (auto r = find_cached(m_hcache, g_shared_caches->m_hcache, key(fn, nargs)))
+            return r;
         auto new_r = mk_hcongr_core(fn, nargs);
         if (new_r)
-            m_hcache.insert(mk_pair(key(fn, nargs), *new_r));
+            save_cached(m_hcache, g_shared_caches->m_hcache, key(fn, nargs), *new_r);
         return new_r;
     }
 
@@ -731,9 +758,11 @@ unsigned congr_lemma_manager::get_specialization_prefix_size(expr const & fn, un
 }
 
 void initialize_congr_lemma_manager() {
+    g_shared_caches = new congr_lemma_shared_caches();
     register_trace_class("congruence_manager");
 }
 
 void finalize_congr_lemma_manager() {
+    delete g_shared_caches;
 }
 }
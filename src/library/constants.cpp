@@ -24,6 +24,7 @@ name const * g_cast_heq = nullptr;
 name const * g_char = nullptr;
 name const * g_char_mk = nullptr;
 name const * g_classical = nullptr;
+name const * g_comm_semigroup = nullptr;
 name const * g_congr = nullptr;
 name const * g_congr_arg = nullptr;
 name const * g_congr_fun = nullptr;
@@ -99,6 +100,7 @@ name const * g_list_nil = nullptr;
 name const * g_list_cons = nullptr;
 name const * g_monoid = nullptr;
 name const * g_mul = nullptr;
+name const * g_mul_comm = nullptr;
 name const * g_mul_one = nullptr;
 name const * g_mul_zero = nullptr;
 name const * g_mul_zero_class = nullptr;
@@ -297,6 +299,7 @@ void initialize_constants() {
     g_char = new name{"char"};
     g_char_mk = new name{"char", "mk"};
     g_classical = new name{"classical"};
+    g_comm_semigroup = new name{"comm_semigroup"};
     g_congr = new name{"congr"};
     g_congr_arg = new name{"congr_arg"};
     g_congr_fun = new name{"congr_fun"};
@@ -372,6 +375,7 @@ void initialize_constants() {
     g_list_cons = new name{"list", "cons"};
     g_monoid = new name{"monoid"};
     g_mul = new name{"mul"};
+    g_mul_comm = new name{"mul", "comm"};
     g_mul_one = new name{"mul_one"};
     g_mul_zero = new name{"mul_zero"};
     g_mul_zero_class = new name{"mul_zero_class"};
@@ -571,6 +575,7 @@ void finalize_constants() {
     delete g_char;
     delete g_char_mk;
     delete g_classical;
+    delete g_comm_semigroup;
     delete g_congr;
     delete g_congr_arg;
     delete g_congr_fun;
@@ -646,6 +651,7 @@ void finalize_constants() {
     delete g_list_cons;
     delete g_monoid;
     delete g_mul;
+    delete g_mul_comm;
     delete g_mul_one;
     delete g_mul_zero;
     delete g_mul_zero_class;
@@ -844,6 +850,7 @@ name const & get_cast_heq_name() { return *g_cast_heq; }
 name const & get_char_name() { return *g_char; }
 name const & get_char_mk_name() { return *g_char_mk; }
 name const & get_classical_name() { return *g_classical; }
+name const & get_comm_semigroup_name() { return *g_comm_semigroup; }
 name const & get_congr_name() { return *g_congr; }
 name const & get_congr_arg_name() { return *g_congr_arg; }
 name const & get_congr_fun_name() { return *g_congr_fun; }
@@ -919,6 +926,7 @@ name const & get_list_nil_name() { return *g_list_nil; }
 name const & get_list_cons_name() { return *g_list_cons; }
 name const & get_monoid_name() { return *g_monoid; }
 name const & get_mul_name() { return *g_mul; }
+name const & get_mul_comm_name() { return *g_mul_comm; }
 name const & get_mul_one_name() { return *g_mul_one; }
 name const & get_mul_zero_name() { return *g_mul_zero; }
 name const & get_mul_zero_class_name() { return *g_mul_zero_class; }
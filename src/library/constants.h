@@ -26,6 +26,7 @@ name const & get_cast_heq_name();
 name const & get_char_name();
 name const & get_char_mk_name();
 name const & get_classical_name();
+name const & get_comm_semigroup_name();
 name const & get_congr_name();
 name const & get_congr_arg_name();
 name const & get_congr_fun_name();
@@ -101,6 +102,7 @@ name const & get_list_nil_name();
 name const & get_list_cons_name();
 name const & get_monoid_name();
 name const & get_mul_name();
+name const & get_mul_comm_name();
 name const & get_mul_one_name();
 name const & get_mul_zero_name();
 name const & get_mul_zero_class_name();
@@ -13,6 +13,7 @@ Author: Daniel Selsam
 #include "library/trace.h"
 #include "library/tmp_type_context.h"
 #include "library/normalize.h"
+#include "library/fun_info_manager.h"
 
 #ifndef LEAN_DEFAULT_DEFEQ_SIMPLIFY_MAX_SIMP_ROUNDS
 #define LEAN_DEFAULT_DEFEQ_SIMPLIFY_MAX_SIMP_ROUNDS 5000
@@ -65,6 +66,7 @@ static bool get_simplify_memoize(options const & o) {
 class defeq_simplify_fn {
     tmp_type_context_pool           & m_tmp_tctx_pool;
     tmp_type_context                * m_tmp_tctx;
+    fun_info_manager                  m_fun_info_manager;
 
     defeq_simp_lemmas                 m_simp_lemmas;
 
@@ -80,6 +82,7 @@ class defeq_simplify_fn {
 
     /* Cache */
     expr_struct_map<expr>             m_cache;
+    expr_struct_map<fun_info>         m_fun_info_cache;
 
     optional<expr> cache_lookup(expr const & e) {
         auto it = m_cache.find(e);
@@ -109,8 +112,8 @@ class defeq_simplify_fn {
                 if (auto it = cache_lookup(e)) return *it;
             }
 
-            if (m_top_down) e = rewrite(whnf_eta(e));
             e = whnf_eta(e);
+            if (m_top_down && has_simp_lemmas(e)) e = whnf_eta(rewrite(e));
 
             switch (e.kind()) {
             case expr_kind::Local:
@@ -158,13 +161,37 @@ class defeq_simplify_fn {
         return update_binding(e, d, b);
     }
 
+    fun_info get_fun_info(expr const & f) {
+        auto it = m_fun_info_cache.find(f);
+        if (it != m_fun_info_cache.end())
+            return it->second;
+        fun_info info = m_fun_info_manager.get(f);
+        m_fun_info_cache.insert(mk_pair(f, info));
+        return info;
+    }
+
+    /* Return true iff the argument \c a for the parameter described by \c pinfo is a proof.
+       If the type of the parameter does not depend on other parameters, then \c pinfo is precise,
+       and no type inference is needed. */
+    bool is_proof_arg(param_info const * pinfo, expr const & a) {
+        if (pinfo && (pinfo->is_prop() || !pinfo->get_dependencies()))
+            return pinfo->is_prop();
+        return m_tmp_tctx->is_prop(m_tmp_tctx->infer(a));
+    }
+
     expr defeq_simplify_app(expr const & e) {
         buffer<expr> args;
         bool modified = false;
         expr f = get_app_rev_args(e, args);
-        for (expr & a : args) {
+        buffer<param_info> pinfos;
+        /* The function may contain temporary (universe) meta-variables of the caller (e.g., blast
+           hi-lemmas), and computing its parameter info would assign them in our context. */
+        if (!has_metavar(f))
+            to_buffer(get_fun_info(f).get_params_info(), pinfos);
+        for (unsigned i = 0; i < args.size(); i++) {
+            expr & a = args[args.size() - i - 1];
             expr new_a = a;
-            if (!m_tmp_tctx->is_prop(m_tmp_tctx->infer(a)))
+            if (!is_proof_arg(i < pinfos.size() ? &pinfos[i] : nullptr, a))
                 new_a = defeq_simplify(a);
             if (new_a != a)
                 modified = true;
@@ -191,6 +218,10 @@ class defeq_simplify_fn {
     }
 
     /* Rewriting */
+    bool has_simp_lemmas(expr const & e) const {
+        return m_simp_lemmas.contains(head_index(e));
+    }
+
     expr rewrite(expr const & _e) {
         expr e = _e;
         while (true) {
@@ -283,6 +314,7 @@ public:
     defeq_simplify_fn(tmp_type_context_pool & tmp_tctx_pool, options const & o, defeq_simp_lemmas const & simp_lemmas):
         m_tmp_tctx_pool(tmp_tctx_pool),
         m_tmp_tctx(m_tmp_tctx_pool.mk_tmp_type_context()),
+        m_fun_info_manager(*m_tmp_tctx),
         m_simp_lemmas(simp_lemmas),
         m_max_simp_rounds(get_simplify_max_simp_rounds(o)),
         m_max_rewrite_rounds(get_simplify_max_rewrite_rounds(o)),
@@ -5,6 +5,10 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #include <unordered_map>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "util/worker_queue.h"
 #include "kernel/expr_maps.h"
 #include "kernel/for_each_fn.h"
 #include "kernel/instantiate.h"
@@ -19,11 +23,58 @@ using level_map = typename std::unordered_map<level, T, level_hash, level_eq>;
 template<typename T>
 using name_hmap = typename std::unordered_map<name, T, name_hash, name_eq>;
 
+#ifndef LEAN_EXPORT_BUFFER_SIZE
+#define LEAN_EXPORT_BUFFER_SIZE (1u << 20)
+#endif
+
+#ifndef LEAN_EXPORT_TASK_SIZE
+#define LEAN_EXPORT_TASK_SIZE 128
+#endif
+
+#ifndef LEAN_EXPORT_BATCH_SIZE
+#define LEAN_EXPORT_BATCH_SIZE 4096
+#endif
+
+/** \brief Buffered output stream. Values are formatted directly into a large buffer,
+    which is written to the underlying stream in big blocks. */
+class export_buffer {
+    std::ostream & m_out;
+    std::string    m_buffer;
+    void check_flush() {
+        if (m_buffer.size() >= LEAN_EXPORT_BUFFER_SIZE)
+            flush();
+    }
+public:
+    export_buffer(std::ostream & out):m_out(out) { m_buffer.reserve(LEAN_EXPORT_BUFFER_SIZE); }
+    ~export_buffer() { flush(); }
+    void flush() {
+        m_out.write(m_buffer.data(), m_buffer.size());
+        m_buffer.clear();
+    }
+    export_buffer & operator<<(char const * s) { m_buffer += s; check_flush(); return *this; }
+    export_buffer & operator<<(unsigned n) {
+        char tmp[16];
+        char * end = tmp + sizeof(tmp);
+        char * it  = end;
+        do {
+            *(--it) = '0' + (n % 10);
+            n /= 10;
+        } while (n != 0);
+        m_buffer.append(it, end);
+        check_flush();
+        return *this;
+    }
+};
+
 
 class exporter {
-    std::ostream &               m_out;
+    export_buffer                m_out;
     environment                  m_env;
     bool                         m_all;
+    unsigned                     m_num_threads;
+    std::vector<expr>            m_roots;    // root expressions in the order they are exported
+    std::vector<expr>            m_unfolded; // m_roots[m_next_root, ...) after macros have been unfolded
+    unsigned                     m_next_root;
     name_set                     m_exported;
     name_hmap<unsigned>          m_name2idx;
     level_map<unsigned>          m_level2idx;
@@ -181,10 +232,89 @@ class exporter {
         return i;
     }
 
+    /** \brief Unfold the macros in the next LEAN_EXPORT_BATCH_SIZE root expressions using multiple threads.
+        Identifiers are still assigned sequentially, since the output must be deterministic. */
+    void unfold_next_roots() {
+        unsigned begin = m_next_root;
+        unsigned end   = std::min(static_cast<unsigned>(m_roots.size()), begin + LEAN_EXPORT_BATCH_SIZE);
+        m_unfolded.clear();
+        m_unfolded.resize(end - begin);
+        environment env = m_env;
+        worker_queue<unsigned> q(m_num_threads - 1);
+        for (unsigned i = begin; i < end; i += LEAN_EXPORT_TASK_SIZE) {
+            unsigned task_end = std::min(end, i + LEAN_EXPORT_TASK_SIZE);
+            q.add([=]() {
+                    for (unsigned j = i; j < task_end; j++)
+                        m_unfolded[j - begin] = unfold_all_macros(env, m_roots[j]);
+                    return task_end - i;
+                });
+        }
+        q.join();
+    }
+
     unsigned export_root_expr(expr const & e) {
+        if (m_next_root < m_roots.size() && is_eqp(m_roots[m_next_root], e)) {
+            unsigned offset = m_next_root % LEAN_EXPORT_BATCH_SIZE;
+            if (offset == 0)
+                unfold_next_roots();
+            m_next_root++;
+            expr r = m_unfolded[offset];
+            m_unfolded[offset] = expr(); // the unfolded root is not needed anymore
+            return export_expr(r);
+        }
         return export_expr(unfold_all_macros(m_env, e));
     }
 
+    void collect_root_dependencies(expr const & e) {
+        for_each(e, [&](expr const & e, unsigned) {
+                if (is_constant(e))
+                    collect_roots(const_name(e));
+                return true;
+            });
+    }
+
+    /** \brief Store in m_roots the root expressions of \c n and its dependencies in the order
+        they are exported. This method mimics #export_declaration. */
+    void collect_roots(name const & n) {
+        if (auto idecls = inductive::is_inductive_decl(m_env, n)) {
+            if (already_exported(n))
+                return;
+            mark(n);
+            inductive::inductive_decl idecl = head(std::get<2>(*idecls));
+            if (m_all) {
+                collect_root_dependencies(inductive::inductive_decl_type(idecl));
+                for (inductive::intro_rule const & c : inductive::inductive_decl_intros(idecl))
+                    collect_root_dependencies(inductive::intro_rule_type(c));
+            }
+            m_roots.push_back(inductive::inductive_decl_type(idecl));
+            for (inductive::intro_rule const & c : inductive::inductive_decl_intros(idecl))
+                m_roots.push_back(inductive::intro_rule_type(c));
+        } else {
+            declaration const & d = m_env.get(n);
+            if (!d.is_definition() && (inductive::is_intro_rule(m_env, n) || inductive::is_elim_rule(m_env, n)))
+                return;
+            if (already_exported(n))
+                return;
+            mark(n);
+            if (m_all) {
+                collect_root_dependencies(d.get_type());
+                if (d.is_definition())
+                    collect_root_dependencies(d.get_value());
+            }
+            m_roots.push_back(d.get_type());
+            if (d.is_definition())
+                m_roots.push_back(d.get_value());
+        }
+    }
+
+    /** \brief Collect the root expressions of all exported declarations. Their macros are unfolded
+        in parallel, LEAN_EXPORT_BATCH_SIZE roots at a time, just before they are exported.
+        So, the unfolded roots do not have to be kept in memory until the end of the export. */
+    void collect_roots() {
+        for_each_exported_declaration([&](name const & n) { collect_roots(n); });
+        m_exported = name_set();
+    }
+
     void export_dependencies(expr const & e) {
         for_each(e, [&](expr const & e, unsigned) {
                 if (is_constant(e)) {
@@ -252,10 +382,11 @@ class exporter {
             export_name(p);
         }
         export_name(inductive::inductive_decl_name(idecl));
-        export_root_expr(inductive::inductive_decl_type(idecl));
+        unsigned t = export_root_expr(inductive::inductive_decl_type(idecl));
+        buffer<unsigned> intro_types;
         for (inductive::intro_rule const & c : inductive::inductive_decl_intros(idecl)) {
             export_name(inductive::intro_rule_name(c));
-            export_root_expr(inductive::intro_rule_type(c));
+            intro_types.push_back(export_root_expr(inductive::intro_rule_type(c)));
         }
         m_out << "#IND"
               << " " << num_params;
@@ -265,15 +396,17 @@ class exporter {
 
         m_out << " |"
               << " " << export_name(inductive::inductive_decl_name(idecl))
-              << " " << export_root_expr(inductive::inductive_decl_type(idecl))
+              << " " << t
               << " " << length(inductive::inductive_decl_intros(idecl))
               << "\n";
 
+        unsigned i = 0;
         for (inductive::intro_rule const & c : inductive::inductive_decl_intros(idecl)) {
             m_out << "#INTRO"
                   << " " << export_name(inductive::intro_rule_name(c))
-                  << " " << export_root_expr(inductive::intro_rule_type(c))
+                  << " " << intro_types[i]
                   << "\n";
+            i++;
         }
     }
 
@@ -289,21 +422,25 @@ class exporter {
         }
     }
 
-    void export_declarations() {
+    template<typename F> void for_each_exported_declaration(F && fn) {
         if (m_all) {
             m_env.for_each_declaration([&](declaration const & d) {
-                    export_declaration(d.get_name());
+                    fn(d.get_name());
                 });
         } else {
             buffer<name> ns;
             to_buffer(get_curr_module_decl_names(m_env), ns);
             std::reverse(ns.begin(), ns.end());
             for (name const & n : ns) {
-                export_declaration(n);
+                fn(n);
             }
         }
     }
 
+    void export_declarations() {
+        for_each_exported_declaration([&](name const & n) { export_declaration(n); });
+    }
+
     void export_direct_imports() {
         if (!m_all) {
             buffer<module_name> imports;
@@ -338,9 +475,12 @@ class exporter {
     }
 
 public:
-    exporter(std::ostream & out, environment const & env, bool all):m_out(out), m_env(env), m_all(all) {}
+    exporter(std::ostream & out, environment const & env, bool all, unsigned num_threads):
+        m_out(out), m_env(env), m_all(all), m_num_threads(num_threads), m_next_root(0) {}
 
     void operator()() {
+        if (m_num_threads > 1)
+            collect_roots();
         m_name2idx.insert(mk_pair(name(), 0));
         m_level2idx.insert(mk_pair(level(), 0));
         export_direct_imports();
@@ -349,11 +489,11 @@ public:
     }
 };
 
-void export_module_as_lowtext(std::ostream & out, environment const & env) {
-    exporter(out, env, false)();
+void export_module_as_lowtext(std::ostream & out, environment const & env, unsigned num_threads) {
+    exporter(out, env, false, num_threads)();
 }
 
-void export_all_as_lowtext(std::ostream & out, environment const & env) {
-    exporter(out, env, true)();
+void export_all_as_lowtext(std::ostream & out, environment const & env, unsigned num_threads) {
+    exporter(out, env, true, num_threads)();
 }
 }
@@ -7,6 +7,9 @@ Author: Leonardo de Moura
 #pragma once
 #include "kernel/environment.h"
 namespace lean {
-void export_module_as_lowtext(std::ostream & out, environment const & env);
-void export_all_as_lowtext(std::ostream & out, environment const & env);
+/** \brief Export the declarations in the current module using the low-level textual format.
+    When \c num_threads > 1, the preprocessing of declarations (e.g., macro expansion) is performed in parallel. */
+void export_module_as_lowtext(std::ostream & out, environment const & env, unsigned num_threads = 1);
+/** \brief Similar to #export_module_as_lowtext, but all declarations in \c env are exported. */
+void export_all_as_lowtext(std::ostream & out, environment const & env, unsigned num_threads = 1);
 }
@@ -10,16 +10,29 @@ Author: Leonardo de Moura
 #include "kernel/instantiate.h"
 #include "kernel/abstract.h"
 #include "library/trace.h"
+#include "library/shared_environment_cache.h"
 #include "library/fun_info_manager.h"
 
 namespace lean {
+typedef shared_environment_cache<expr_unsigned, fun_info, expr_unsigned_hash_fn, expr_unsigned_eq_fn> fun_info_shared_cache;
 static name * g_fun_info = nullptr;
+/* Shared caches for get(fn), get(fn, nargs) and get_specialized(app) */
+static fun_info_shared_cache * g_cache_get       = nullptr;
+static fun_info_shared_cache * g_cache_get_nargs = nullptr;
+static fun_info_shared_cache * g_cache_get_spec  = nullptr;
+
 void initialize_fun_info_manager() {
-    g_fun_info = new name("fun_info");
+    g_fun_info        = new name("fun_info");
+    g_cache_get       = new fun_info_shared_cache();
+    g_cache_get_nargs = new fun_info_shared_cache();
+    g_cache_get_spec  = new fun_info_shared_cache();
     register_trace_class(*g_fun_info);
 }
 
 void finalize_fun_info_manager() {
+    delete g_cache_get_spec;
+    delete g_cache_get_nargs;
+    delete g_cache_get;
     delete g_fun_info;
 }
 
@@ -29,8 +42,14 @@ static bool is_fun_info_trace_enabled() {
     return is_trace_class_enabled(*g_fun_info);
 }
 
-fun_info_manager::fun_info_manager(type_context & ctx):
-    m_ctx(ctx) {
+fun_info_manager::fun_info_manager(type_context & ctx, bool use_shared_cache):
+    m_ctx(ctx), m_use_shared_cache(use_shared_cache) {
+}
+
+bool fun_info_manager::use_shared_cache(expr const & e) const {
+    return
+        m_use_shared_cache && closed(e) && !has_local(e) && !has_metavar(e) &&
+        !m_ctx.has_local_instances();
 }
 
 list<unsigned> fun_info_manager::collect_deps(expr const & type, buffer<expr> const & locals) {
@@ -86,25 +105,43 @@ list<unsigned> fun_info_manager::get_core(expr const & fn, buffer<param_info> &
 }
 
 fun_info fun_info_manager::get(expr const & e) {
-    auto it = m_cache_get.find(e);
-    if (it != m_cache_get.end())
-        return it->second;
+    bool shared = use_shared_cache(e);
+    if (shared) {
+        if (auto r = g_cache_get->find(m_ctx.env(), expr_unsigned(e, 0)))
+            return *r;
+    } else {
+        auto it = m_cache_get.find(e);
+        if (it != m_cache_get.end())
+            return it->second;
+    }
     buffer<param_info> pinfos;
     auto result_deps = get_core(e, pinfos, std::numeric_limits<unsigned>::max(), true);
     fun_info r(pinfos.size(), to_list(pinfos), result_deps);
-    m_cache_get.insert(mk_pair(e, r));
+    if (shared)
+        g_cache_get->insert(m_ctx.env(), expr_unsigned(e, 0), r);
+    else
+        m_cache_get.insert(mk_pair(e, r));
     return r;
 }
 
 fun_info fun_info_manager::get(expr const & e, unsigned nargs) {
     expr_unsigned key(e, nargs);
-    auto it = m_cache_get_nargs.find(key);
-    if (it != m_cache_get_nargs.end())
-        return it->second;
+    bool shared = use_shared_cache(e);
+    if (shared) {
+        if (auto r = g_cache_get_nargs->find(m_ctx.env(), key))
+            return *r;
+    } else {
+        auto it = m_cache_get_nargs.find(key);
+        if (it != m_cache_get_nargs.end())
+            return it->second;
+    }
     buffer<param_info> pinfos;
     auto result_deps = get_core(e, pinfos, nargs, true);
     fun_info r(pinfos.size(), to_list(pinfos), result_deps);
-    m_cache_get_nargs.insert(mk_pair(key, r));
+    if (shared)
+        g_cache_get_nargs->insert(m_ctx.env(), key, r);
+    else
+        m_cache_get_nargs.insert(mk_pair(key, r));
     return r;
 }
 
@@ -227,9 +264,14 @@ fun_info fun_info_manager::get_specialized(expr const & a) {
     for (unsigned i = 0; i < num_rest_args; i++)
         g = app_fn(g);
     expr_unsigned key(g, num_rest_args);
-    auto it = m_cache_get_spec.find(key);
-    if (it != m_cache_get_spec.end()) {
-        return it->second;
+    bool shared = use_shared_cache(g);
+    if (shared) {
+        if (auto r = g_cache_get_spec->find(m_ctx.env(), key))
+            return *r;
+    } else {
+        auto it = m_cache_get_spec.find(key);
+        if (it != m_cache_get_spec.end())
+            return it->second;
     }
     /* fun_info is not cached */
     buffer<param_info> pinfos;
@@ -239,7 +281,10 @@ fun_info fun_info_manager::get_specialized(expr const & a) {
     }
     auto result_deps = get_core(g, pinfos, num_rest_args, true);
     fun_info r(pinfos.size(), to_list(pinfos), result_deps);
-    m_cache_get_spec.insert(mk_pair(key, r));
+    if (shared)
+        g_cache_get_spec->insert(m_ctx.env(), key, r);
+    else
+        m_cache_get_spec.insert(mk_pair(key, r));
     trace_if_unsupported(fn, args, prefix_sz, r);
     return r;
 }
@@ -74,6 +74,7 @@ public:
     dependencies, implicit binder info, etc. */
 class fun_info_manager {
     type_context &                         m_ctx;
+    bool                                   m_use_shared_cache;
     typedef expr_map<fun_info>          cache;
     typedef expr_unsigned_map<fun_info> narg_cache;
     typedef expr_unsigned_map<unsigned> prefix_cache;
@@ -85,8 +86,15 @@ class fun_info_manager {
     list<unsigned> get_core(expr const & e, buffer<param_info> & pinfos, unsigned max_args, bool compute_resulting_deps);
     void trace_if_unsupported(expr const & fn, buffer<expr> const & args, unsigned prefix_sz, fun_info const & result);
 public:
-    fun_info_manager(type_context & ctx);
+    /** \brief When \c use_shared_cache is true, the information for closed terms is also stored in
+        a cache shared by all threads and \c fun_info_manager objects using the same environment.
+        This is only safe if the behavior of \c ctx is determined by its environment
+        (e.g., it only unfolds reducible constants). */
+    fun_info_manager(type_context & ctx, bool use_shared_cache = false);
     type_context & ctx() { return m_ctx; }
+    /** \brief Return true iff information about \c e can be stored in the shared caches.
+        That is, \c e is closed, and the local context does not contain instances. */
+    bool use_shared_cache(expr const & e) const;
     fun_info get(expr const & fn);
     /** \brief Return information assuming the function has only nargs.
         \pre nargs <= get(fn).get_arity() */
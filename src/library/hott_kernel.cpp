@@ -11,14 +11,15 @@ Author: Leonardo de Moura
 namespace lean {
 using inductive::inductive_normalizer_extension;
 /** \brief Create Lean environment for Homotopy Type Theory */
-environment mk_hott_environment(unsigned trust_lvl) {
+environment mk_hott_environment(unsigned trust_lvl, bool whnf_machine) {
     environment env = environment(trust_lvl,
                                   false /* Type.{0} is not proof irrelevant */,
                                   true  /* Eta */,
                                   false /* Type.{0} is not impredicative */,
                                   /* builtin support for inductive and hits */
                                   compose(std::unique_ptr<normalizer_extension>(new inductive_normalizer_extension()),
-                                          std::unique_ptr<normalizer_extension>(new hits_normalizer_extension())));
+                                          std::unique_ptr<normalizer_extension>(new hits_normalizer_extension())),
+                                  whnf_machine);
     return set_unifier_plugin(env, mk_inductive_unifier_plugin());
 }
 }
@@ -9,5 +9,5 @@ Author: Leonardo de Moura
 
 namespace lean {
 /** \brief Create Lean environment for Homotopy Type Theory */
-environment mk_hott_environment(unsigned trust_lvl = 0);
+environment mk_hott_environment(unsigned trust_lvl = 0, bool whnf_machine = false);
 }
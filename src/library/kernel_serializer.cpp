@@ -15,8 +15,8 @@ Author: Leonardo de Moura
 // Procedures for serializing and deserializing kernel objects (levels, exprs, declarations)
 namespace lean {
 // Universe level serialization
-class level_serializer : public object_serializer<level, level::ptr_hash, level::ptr_eq> {
-    typedef object_serializer<level, level::ptr_hash, level::ptr_eq> super;
+class level_serializer : public object_serializer<level, level_hash, level_eq> {
+    typedef object_serializer<level, level_hash, level_eq> super;
 public:
     void write(level const & l) {
         super::write(l, [&]() {
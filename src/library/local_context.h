@@ -5,6 +5,7 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #pragma once
+#include "util/rb_map.h"
 #include "util/name_map.h"
 #include "kernel/expr.h"
 
@@ -11,6 +11,7 @@ Author: Leonardo de Moura
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <cstring>
 #include <sys/stat.h>
 #include "util/hash.h"
 #include "util/thread.h"
@@ -29,12 +30,17 @@ Author: Leonardo de Moura
 #include "library/constants.h"
 #include "library/kernel_serializer.h"
 #include "library/unfold_macros.h"
+#include "library/verification_ledger.h"
 #include "version.h"
 
 #ifndef LEAN_ASYNCH_IMPORT_THEOREM
 #define LEAN_ASYNCH_IMPORT_THEOREM false
 #endif
 
+#ifndef LEAN_IMPORT_CACHE_CAPACITY
+#define LEAN_IMPORT_CACHE_CAPACITY 8
+#endif
+
 namespace lean {
 corrupted_file_exception::corrupted_file_exception(std::string const & fname):
     exception(sstream() << "failed to import '" << fname << "', file is corrupted, please regenerate the file from sources") {
@@ -110,8 +116,12 @@ bool direct_imports_have_changed(environment const & env) {
     return false;
 }
 
-static char const * g_olean_end_file = "EndFile";
-static char const * g_olean_header   = "oleanfile";
+static char const * g_olean_end_file   = "EndFile";
+/* The header of object files is stored as raw bytes, i.e., it is not affected by the string table
+   of the serializer. Object files produced before the string table was introduced start with
+   the null-terminated string g_old_olean_header. */
+static char const * g_olean_header     = "oleanfile2";
+static char const * g_old_olean_header = "oleanfile";
 
 serializer & operator<<(serializer & s, module_name const & n) {
     if (n.is_relative())
@@ -156,7 +166,9 @@ void export_module(std::ostream & out, environment const & env) {
     serializer s2(out);
     std::string r = out1.str();
     unsigned h    = hash(r.size(), [&](unsigned i) { return r[i]; });
-    s2 << g_olean_header << LEAN_VERSION_MAJOR << LEAN_VERSION_MINOR << LEAN_VERSION_PATCH;
+    for (char const * it = g_olean_header; *it; ++it)
+        s2.write_char(*it);
+    s2 << LEAN_VERSION_MAJOR << LEAN_VERSION_MINOR << LEAN_VERSION_PATCH;
     s2 << h;
     // store imported files
     s2 << imports.size();
@@ -240,7 +252,7 @@ environment declare_quotient(environment const & env) {
 static void quotient_reader(deserializer &, shared_environment & senv,
                             std::function<void(asynch_update_fn const &)>  &,
                             std::function<void(delayed_update_fn const &)> &) {
-    senv.update([&](environment const & env) {
+    senv.update([=](environment const & env) {
             return ::lean::declare_quotient(env);
         });
 }
@@ -253,7 +265,7 @@ environment declare_hits(environment const & env) {
 static void hits_reader(deserializer &, shared_environment & senv,
                         std::function<void(asynch_update_fn const &)>  &,
                         std::function<void(delayed_update_fn const &)> &) {
-    senv.update([&](environment const & env) {
+    senv.update([=](environment const & env) {
             return ::lean::declare_hits(env);
         });
 }
@@ -279,7 +291,7 @@ static void inductive_reader(deserializer & d, shared_environment & senv,
                              std::function<void(asynch_update_fn const &)>  &,
                              std::function<void(delayed_update_fn const &)> &) {
     certified_inductive_decl cdecl = read_certified_inductive_decl(d);
-    senv.update([&](environment const & env) {
+    senv.update([=](environment const & env) {
             return cdecl.add(env);
         });
 }
@@ -307,20 +319,25 @@ struct import_modules_fn {
 
     struct module_info {
         std::string                               m_fname;
-        atomic<unsigned>                          m_counter; // number of dependencies to be processed
+        atomic<unsigned>                          m_counter; // number of dependencies to be processed (+1 until decoded)
         unsigned                                  m_module_idx;
         std::vector<std::shared_ptr<module_info>> m_dependents;
         std::vector<char>                         m_obj_code;
+        // decoded objects, they are applied to the environment after all dependencies have been imported
+        std::vector<std::function<void()>>        m_objects;
         module_info():m_counter(0), m_module_idx(0) {}
     };
     typedef std::shared_ptr<module_info> module_info_ptr;
     name_map<module_info_ptr> m_module_info;
     name_set                  m_visited; // contains visited files in the current call
     name_set                  m_imported; // contains all imported files, even ones from previous calls
+    verification_ledger *     m_ledger;
+    declaration_key_fn        m_decl_key;
 
     import_modules_fn(environment const & env, unsigned num_threads, bool keep_proofs, io_state const & ios):
         m_senv(env), m_num_threads(num_threads), m_keep_proofs(keep_proofs), m_ios(ios),
-        m_next_module_idx(1), m_import_counter(0), m_all_modules_imported(false) {
+        m_next_module_idx(1), m_import_counter(0), m_all_modules_imported(false),
+        m_ledger(get_verification_ledger()) {
         module_ext const & ext = get_extension(env);
         m_imported = ext.m_imported;
         if (m_num_threads == 0)
@@ -329,10 +346,6 @@ struct import_modules_fn {
         if (m_num_threads > 1)
             m_num_threads = 1;
 #endif
-        if (env.trust_lvl() > 0) {
-            // it doesn't payoff to use multiple threads if we will not type check anything
-            m_num_threads = 1;
-        }
     }
 
     module_info_ptr load_module_file(std::string const & base, module_name const & mname) {
@@ -358,9 +371,14 @@ struct import_modules_fn {
                     throw exception(sstream() << "failed to open file '" << fname << "'");
                 deserializer d1(in);
                 std::string header;
-                d1 >> header;
-                if (header != g_olean_header)
+                for (unsigned i = 0; g_olean_header[i]; i++)
+                    header += d1.read_char();
+                if (header != g_olean_header) {
+                    if (header.compare(0, strlen(g_old_olean_header), g_old_olean_header) == 0)
+                        throw exception(sstream() << "file '" << fname << "' was produced by an older version of Lean, "
+                                        << "please regenerate the file from sources");
                     throw exception(sstream() << "file '" << fname << "' does not seem to be a valid object Lean file, invalid header");
+                }
                 d1 >> major >> minor >> patch >> claimed_hash;
                 // Enforce version?
 
@@ -381,24 +399,22 @@ struct import_modules_fn {
 
             module_info_ptr r = std::make_shared<module_info>();
             r->m_fname        = fname;
-            r->m_counter      = 0;
+            r->m_counter      = 1; // the module itself must be decoded
             r->m_module_idx   = 0;
             m_import_counter++;
             std::string new_base = dirname(fname.c_str());
             std::swap(r->m_obj_code, code);
-            bool has_dependency = false;
             for (auto i : imports) {
                 if (auto d = load_module_file(new_base, i)) {
                     r->m_counter++;
                     d->m_dependents.push_back(r);
-                    has_dependency = true;
                 }
             }
             m_module_info.insert(fname, r);
             r->m_module_idx = m_next_module_idx++;
 
-            if (!has_dependency)
-                add_import_module_task(r);
+            // decoding does not depend on the environment, so it can start before the dependencies are imported
+            add_decode_module_task(r);
             return r;
         } catch (corrupted_stream_exception&) {
             throw corrupted_file_exception(fname);
@@ -417,13 +433,31 @@ struct import_modules_fn {
         add_asynch_task([=](shared_environment &) { import_module(r); });
     }
 
+    void add_decode_module_task(module_info_ptr const & r) {
+        add_asynch_task([=](shared_environment &) { decode_module(r); });
+    }
+
+    /** \brief Notify \c r that one of its pending tasks (decoding or importing a dependency) has been completed. */
+    void release_module(module_info_ptr const & r) {
+        if (atomic_fetch_sub_explicit(&(r->m_counter), 1u, memory_order_release) == 1u) {
+            atomic_thread_fence(memory_order_acquire);
+            // r has been decoded, and all its dependencies have been processed
+            add_import_module_task(r);
+        }
+    }
+
     declaration theorem2axiom(declaration const & decl) {
         lean_assert(decl.is_theorem());
         return mk_axiom(decl.get_name(), decl.get_univ_params(), decl.get_type());
     }
 
-    void import_decl(deserializer & d) {
-        declaration decl = read_declaration(d);
+    /** \brief Store in the ledger (if any) that the declaration with the given key was successfully checked. */
+    void record_verified(optional<ledger_key> const & key) {
+        if (key)
+            m_ledger->add(*key);
+    }
+
+    void import_decl(declaration decl) {
         environment env  = m_senv.env();
         decl = unfold_untrusted_macros(env, decl);
         if (decl.get_name() == get_sorry_name() && has_sorry(env))
@@ -433,6 +467,17 @@ struct import_modules_fn {
                 m_senv.add(theorem2axiom(decl));
             else
                 m_senv.add(decl);
+            return;
+        }
+        optional<ledger_key> key;
+        if (m_ledger)
+            key = m_decl_key(env, decl);
+        if (key && m_ledger->contains(*key)) {
+            // declaration and its dependencies were checked in a previous run
+            if (!m_keep_proofs && decl.is_theorem())
+                m_senv.add(check_previously_verified(env, theorem2axiom(decl)));
+            else
+                m_senv.add(check_previously_verified(env, decl));
         } else if (LEAN_ASYNCH_IMPORT_THEOREM && decl.is_theorem()) {
             // First, we add the theorem as an axiom, and create an asychronous task for
             // checking the actual theorem, and replace the axiom with the actual theorem.
@@ -440,6 +485,7 @@ struct import_modules_fn {
             m_senv.add(tmp_c);
             add_asynch_task([=](shared_environment & m_senv) {
                     certified_declaration c = check(env, decl);
+                    record_verified(key);
                     if (m_keep_proofs)
                         m_senv.replace(c);
                 });
@@ -452,58 +498,79 @@ struct import_modules_fn {
                 certified_declaration c = check(env, decl);
                 m_senv.add(c);
             }
+            record_verified(key);
         }
     }
 
-    void import_universe(deserializer & d) {
-        name const l = read_name(d);
+    void import_universe(name const & l) {
         m_senv.update([=](environment const & env) { return env.add_universe(l); });
     }
 
-    void import_module(module_info_ptr const & r) {
-        std::string s(r->m_obj_code.data(), r->m_obj_code.size());
-        std::istringstream in(s, std::ios_base::binary);
-        deserializer d(in);
+    /** \brief Decode the objects stored in \c r. The environment is not modified, the decoded objects
+        are stored in \c r->m_objects, and are processed by #import_module. */
+    void decode_module(module_info_ptr const & r) {
+        char const * code = r->m_obj_code.data();
+        deserializer d(code, code + r->m_obj_code.size());
+        std::vector<std::function<void()>> & objects = r->m_objects;
         unsigned obj_counter = 0;
         std::function<void(asynch_update_fn const &)> add_asynch_update([&](asynch_update_fn const & f) {
-                add_asynch_task(f);
+                objects.push_back([=]() { add_asynch_task(f); });
             });
         std::function<void(delayed_update_fn const &)> add_delayed_update([&](delayed_update_fn const & f) {
                 lock_guard<mutex> lk(m_delayed_mutex);
                 m_delayed_tasks.push_back(std::make_tuple(r->m_module_idx, obj_counter, f));
             });
-        while (true) {
-            check_interrupted();
-            std::string k;
-            d >> k;
-            if (k == g_olean_end_file) {
-                break;
-            } else if (k == *g_decl_key) {
-                import_decl(d);
-            } else if (k == *g_glvl_key) {
-                import_universe(d);
-            } else {
-                object_readers & readers = get_object_readers();
-                auto it = readers.find(k);
-                if (it == readers.end())
-                    throw exception(sstream() << "file '" << r->m_fname << "' has been corrupted, unknown object");
-                it->second(d, m_senv, add_asynch_update, add_delayed_update);
+        try {
+            while (true) {
+                check_interrupted();
+                std::string k;
+                d >> k;
+                if (k == g_olean_end_file) {
+                    break;
+                } else if (k == *g_decl_key) {
+                    declaration decl = read_declaration(d);
+                    objects.push_back([=]() { import_decl(decl); });
+                } else if (k == *g_glvl_key) {
+                    name l = read_name(d);
+                    objects.push_back([=]() { import_universe(l); });
+                } else {
+                    object_readers & readers = get_object_readers();
+                    auto it = readers.find(k);
+                    if (it == readers.end())
+                        throw exception(sstream() << "file '" << r->m_fname << "' has been corrupted, unknown object");
+                    std::vector<shared_environment::update_fn> updates;
+                    shared_environment deferred(&updates);
+                    it->second(d, deferred, add_asynch_update, add_delayed_update);
+                    if (!updates.empty()) {
+                        objects.push_back([=]() {
+                                for (auto const & f : updates)
+                                    m_senv.update(f);
+                            });
+                    }
+                }
+                obj_counter++;
             }
-            obj_counter++;
+        } catch (corrupted_stream_exception &) {
+            throw corrupted_file_exception(r->m_fname);
         }
+        std::vector<char>().swap(r->m_obj_code);
+        release_module(r);
+    }
+
+    void import_module(module_info_ptr const & r) {
+        for (auto const & obj : r->m_objects) {
+            check_interrupted();
+            obj();
+        }
+        std::vector<std::function<void()>>().swap(r->m_objects);
         if (atomic_fetch_sub_explicit(&m_import_counter, 1u, memory_order_release) == 1u) {
             atomic_thread_fence(memory_order_acquire);
             m_all_modules_imported = true;
             m_asynch_cv.notify_all();
         }
         // Module was successfully imported, we should notify descendents.
-        for (module_info_ptr const & d : r->m_dependents) {
-            if (atomic_fetch_sub_explicit(&(d->m_counter), 1u, memory_order_release) == 1u) {
-                atomic_thread_fence(memory_order_acquire);
-                // all d's dependencies have been processed
-                add_import_module_task(d);
-            }
-        }
+        for (module_info_ptr const & d : r->m_dependents)
+            release_module(d);
     }
 
     optional<asynch_update_fn> next_task() {
@@ -611,9 +678,83 @@ struct import_modules_fn {
     }
 };
 
+struct import_cache::entry {
+    environment                                   m_env;    // environment the modules were imported into
+    std::string                                   m_key;
+    environment                                   m_result;
+    std::vector<std::pair<std::string, time_t>>   m_files;  // imported files and their modification times
+};
+
+import_cache::import_cache(unsigned capacity):m_capacity(capacity) {}
+import_cache::import_cache():import_cache(LEAN_IMPORT_CACHE_CAPACITY) {}
+
+static bool is_same_environment(environment const & env1, environment const & env2) {
+    return env1.get_id().is_descendant(env2.get_id()) && env2.get_id().is_descendant(env1.get_id());
+}
+
+optional<environment> import_cache::find(environment const & env, std::string const & key) {
+    lock_guard<mutex> lc(m_mutex);
+    for (unsigned i = 0; i < m_entries.size(); i++) {
+        std::shared_ptr<entry> e = m_entries[i];
+        if (e->m_key != key || !is_same_environment(e->m_env, env))
+            continue;
+        m_entries.erase(m_entries.begin() + i);
+        for (auto const & p : e->m_files) {
+            struct stat st;
+            if (stat(p.first.c_str(), &st) != 0 || st.st_mtime != p.second)
+                return optional<environment>(); // stale entry
+        }
+        m_entries.push_back(e);
+        return optional<environment>(e->m_result);
+    }
+    return optional<environment>();
+}
+
+void import_cache::insert(environment const & env, std::string const & key, environment const & r) {
+    std::shared_ptr<entry> e = std::make_shared<entry>();
+    e->m_env    = env;
+    e->m_key    = key;
+    e->m_result = r;
+    get_extension(r).m_imported.for_each([&](name const & fname) {
+            std::string f = fname.to_string();
+            struct stat st;
+            if (stat(f.c_str(), &st) == 0)
+                e->m_files.emplace_back(f, st.st_mtime);
+        });
+    lock_guard<mutex> lc(m_mutex);
+    if (m_entries.size() >= m_capacity)
+        m_entries.erase(m_entries.begin());
+    m_entries.push_back(e);
+}
+
+void import_cache::clear() {
+    lock_guard<mutex> lc(m_mutex);
+    m_entries.clear();
+}
+
+static import_cache * g_import_cache = nullptr;
+
+void set_import_cache(import_cache * c) {
+    g_import_cache = c;
+}
+
 environment import_modules(environment const & env, std::string const & base, unsigned num_modules, module_name const * modules,
                            unsigned num_threads, bool keep_proofs, io_state const & ios) {
-    return import_modules_fn(env, num_threads, keep_proofs, ios)(base, num_modules, modules);
+    import_cache * cache = g_import_cache;
+    if (!cache)
+        return import_modules_fn(env, num_threads, keep_proofs, ios)(base, num_modules, modules);
+    std::ostringstream key;
+    key << base << "\n" << keep_proofs << "\n";
+    for (unsigned i = 0; i < num_modules; i++) {
+        if (auto k = modules[i].get_k())
+            key << *k;
+        key << ":" << modules[i].get_name() << "\n";
+    }
+    if (auto r = cache->find(env, key.str()))
+        return *r;
+    environment r = import_modules_fn(env, num_threads, keep_proofs, ios)(base, num_modules, modules);
+    cache->insert(env, key.str(), r);
+    return r;
 }
 
 environment import_module(environment const & env, std::string const & base, module_name const & module,
@@ -6,6 +6,8 @@ Author: Leonardo de Moura
 */
 #pragma once
 #include <string>
+#include <vector>
+#include <memory>
 #include <iostream>
 #include "util/serializer.h"
 #include "util/optional.h"
@@ -50,6 +52,25 @@ environment import_modules(environment const & env, std::string const & base, un
 environment import_module(environment const & env, std::string const & base, module_name const & module,
                           unsigned num_threads, bool keep_proofs, io_state const & ios);
 
+/** \brief Cache for the environments produced by #import_modules.
+    An entry is reused if the same modules are imported into the same environment, and
+    none of the imported .olean files (directly or indirectly) has been modified. */
+class import_cache {
+    struct entry;
+    mutex                               m_mutex;
+    std::vector<std::shared_ptr<entry>> m_entries; // the most recently used entry is the last one
+    unsigned                            m_capacity;
+public:
+    import_cache(unsigned capacity);
+    import_cache();
+    optional<environment> find(environment const & env, std::string const & key);
+    void insert(environment const & env, std::string const & key, environment const & r);
+    void clear();
+};
+
+/** \brief Set the cache used by #import_modules. When \c c is nullptr (default), modules are always imported. */
+void set_import_cache(import_cache * c);
+
 /** \brief Return the direct imports of the main module in the given environment. */
 list<module_name> get_direct_imports(environment const & env);
 
@@ -75,6 +96,10 @@ typedef std::function<environment(environment const & env, io_state const & ios)
      1- Direct update it using \c senv.
      2- Asynchronous update using add_asynch_update.
      3- Delayed update using add_delayed_update.
+
+    \remark Readers may be executed before the modules the object depends on have been imported.
+    So, they must not inspect \c senv, and the functions given to \c senv.update must not capture
+    references to local variables.
 */
 typedef void (*module_object_reader)(deserializer & d, shared_environment & senv,
                                      std::function<void(asynch_update_fn const &)> & add_asynch_update,
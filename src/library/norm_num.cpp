@@ -3,6 +3,7 @@ Copyright (c) 2015 Microsoft Corporation. All rights reserved.
 Released under Apache 2.0 license as described in the file LICENSE.
 Author: Robert Y. Lewis
 */
+#include "util/sstream.h"
 #include "library/norm_num.h"
 #include "library/constants.h"
 
@@ -38,301 +39,105 @@ bool norm_num_context::is_div(expr const & e) const {
 }
 
 /*
-Takes A : Type, and tries to synthesize has_add A.
+Takes a class C and A : Type, and tries to synthesize C A.
+The instances are cached using (C.{m_lvls} A) as the key, i.e., the cache is indexed by class, type and universe.
 */
-expr norm_num_context::mk_has_add(expr const & e) {
-    auto l_name = get_has_add_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
+optional<expr> norm_num_context::try_mk_instance(name const & cls, expr const & e) {
+    expr t = mk_app(mk_constant(cls, m_lvls), e);
+    auto it = m_instances.find(t);
+    if (it != m_instances.end())
+        return some_expr(it->second);
     optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
+    if (inst)
+        m_instances.insert(mk_pair(t, *inst));
+    return inst;
+}
+
+expr norm_num_context::mk_instance(name const & cls, expr const & e) {
+    if (auto inst = try_mk_instance(cls, e))
         return *inst;
-    } else {
-        throw exception("failed to synthesize has_add instance");
-    }
+    else
+        throw exception(sstream() << "failed to synthesize " << cls << " instance");
+}
+
+expr norm_num_context::mk_has_add(expr const & e) {
+    return mk_instance(get_has_add_name(), e);
 }
 
 expr norm_num_context::mk_has_mul(expr const & e) {
-    auto l_name = get_has_mul_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_mul instance");
-    }
+    return mk_instance(get_has_mul_name(), e);
 }
 
 expr norm_num_context::mk_has_one(expr const & e) {
-    auto l_name = get_has_one_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_one instance");
-    }
+    return mk_instance(get_has_one_name(), e);
 }
 
 expr norm_num_context::mk_has_zero(expr const & e) {
-    auto l_name = get_has_zero_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_one instance");
-    }
+    return mk_instance(get_has_zero_name(), e);
 }
 
 expr norm_num_context::mk_add_monoid(expr const & e) {
-    auto l_name = get_add_monoid_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize add_monoid instance");
-    }
+    return mk_instance(get_add_monoid_name(), e);
 }
 
 expr norm_num_context::mk_monoid(expr const & e) {
-    auto l_name = get_monoid_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize monoid instance");
-    }
+    return mk_instance(get_monoid_name(), e);
 }
 
 expr norm_num_context::mk_field(expr const & e) {
-    expr t = mk_app(mk_constant(get_field_name(), m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        return *inst;
-    } else {
-        throw exception("failed to synthesize field instance");
-    }
+    return mk_instance(get_field_name(), e);
 }
 
 expr norm_num_context::mk_add_comm(expr const & e) {
-    auto l_name = get_add_comm_semigroup_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize add_comm_semigroup instance");
-    }
+    return mk_instance(get_add_comm_semigroup_name(), e);
 }
 
 expr norm_num_context::mk_add_group(expr const & e) {
-    auto l_name = get_add_group_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize add_comm_semigroup instance");
-    }
+    return mk_instance(get_add_group_name(), e);
 }
 
 expr norm_num_context::mk_has_distrib(expr const & e) {
-    auto l_name = get_distrib_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_distrib instance");
-    }
+    return mk_instance(get_distrib_name(), e);
 }
 
 expr norm_num_context::mk_mul_zero_class(expr const & e) {
-    auto l_name = get_mul_zero_class_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize mul_zero instance");
-    }
+    return mk_instance(get_mul_zero_class_name(), e);
 }
 
 expr norm_num_context::mk_semiring(expr const & e) {
-    auto l_name = get_semiring_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize semiring instance");
-    }
+    return mk_instance(get_semiring_name(), e);
 }
 
 expr norm_num_context::mk_has_neg(expr const & e) {
-    auto l_name = get_has_neg_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_neg instance");
-    }
+    return mk_instance(get_has_neg_name(), e);
 }
 
 expr norm_num_context::mk_has_sub(expr const & e) {
-    auto l_name = get_has_sub_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_sub instance");
-    }
+    return mk_instance(get_has_sub_name(), e);
 }
 
 expr norm_num_context::mk_has_div(expr const & e) {
-    auto l_name = get_has_div_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize has_div instance");
-    }
+    return mk_instance(get_has_div_name(), e);
 }
 
 expr norm_num_context::mk_add_comm_group(expr const & e) {
-    auto l_name = get_add_comm_group_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize add_comm_group instance");
-    }
+    return mk_instance(get_add_comm_group_name(), e);
 }
 
 expr norm_num_context::mk_ring(expr const & e) {
-    auto l_name = get_ring_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize ring instance");
-    }
+    return mk_instance(get_ring_name(), e);
 }
 
 expr norm_num_context::mk_lin_ord_ring(expr const & e) {
-    auto l_name = get_linear_ordered_ring_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize lin_ord_ring instance");
-    }
+    return mk_instance(get_linear_ordered_ring_name(), e);
 }
 
 expr norm_num_context::mk_lin_ord_semiring(expr const & e) {
-    auto l_name = get_linear_ordered_semiring_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize lin_ord_semiring instance");
-    }
+    return mk_instance(get_linear_ordered_semiring_name(), e);
 }
 
 expr norm_num_context::mk_wk_order(expr const & e) {
-    auto l_name = get_weak_order_name();
-    if (instances.find(l_name) != instances.end()) {
-        return instances[l_name];
-    }
-    expr t = mk_app(mk_constant(l_name, m_lvls), e);
-    optional<expr> inst = m_type_ctx.mk_class_instance(t);
-    if (inst) {
-        instances[l_name] = *inst;
-        return *inst;
-    } else {
-        throw exception("failed to synthesize weak_order instance");
-    }
+    return mk_instance(get_weak_order_name(), e);
 }
 
 expr norm_num_context::mk_const(name const & n) {
@@ -637,11 +442,26 @@ expr norm_num_context::mk_norm_eq_pos_mul_neg(expr & s_lhs, expr & s_rhs, expr &
                 rhs_v, prod_pr.second});
 }
 
-// returns a proof that s_lhs + s_rhs = rhs, where all are nonneg normalized numerals
-expr norm_num_context::mk_norm_eq_pos_mul_pos(expr & s_lhs, expr & s_rhs, expr & DEBUG_CODE(rhs)) {
+// returns a proof that s_lhs * s_rhs = rhs, where all are nonneg normalized numerals
+expr norm_num_context::mk_norm_eq_pos_mul_pos(expr & s_lhs, expr & s_rhs, expr & rhs) {
     lean_assert(!is_neg_app(s_lhs));
     lean_assert(!is_neg_app(s_rhs));
     lean_assert(!is_neg_app(rhs));
+    // mk_norm_mul recurses on the bits of its second argument, and each bit1 produces an addition proof.
+    // So, when the multiplication is commutative, we use the smaller numeral as the second argument.
+    optional<mpz> v_lhs = to_num(s_lhs), v_rhs = to_num(s_rhs);
+    if (v_lhs && v_rhs && *v_rhs > *v_lhs) {
+        buffer<expr> args;
+        get_app_args(s_rhs, args);
+        expr type = args[0];
+        if (auto comm = try_mk_instance(get_comm_semigroup_name(), type)) {
+            auto p = mk_norm_mul(s_rhs, s_lhs);
+            lean_assert(to_num(rhs) == to_num(p.first));
+            expr comm_pr = mk_app({mk_const(get_mul_comm_name()), type, *comm, s_lhs, s_rhs});
+            return mk_app({mk_const(get_eq_trans_name()), type, mk_mul(type, s_lhs, s_rhs),
+                        mk_mul(type, s_rhs, s_lhs), rhs, comm_pr, p.second});
+        }
+    }
     auto p = mk_norm_mul(s_lhs, s_rhs);
     lean_assert(to_num(rhs) == to_num(p.first));
     return p.second;
@@ -815,6 +635,15 @@ expr norm_num_context::mk_norm_mul_div(expr & s_lhs, expr & s_rhs, expr & rhs) {
 }
 
 pair<expr, expr> norm_num_context::mk_norm(expr const & e) {
+    auto it = m_cache.find(e);
+    if (it != m_cache.end())
+        return it->second;
+    pair<expr, expr> r = mk_norm_core(e);
+    m_cache.insert(mk_pair(e, r));
+    return r;
+}
+
+pair<expr, expr> norm_num_context::mk_norm_core(expr const & e) {
     buffer<expr> args;
     expr f = get_app_args(e, args);
     if (!is_constant(f) || args.size() == 0) {
@@ -4,25 +4,28 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Robert Y. Lewis
 */
 #pragma once
+#include "util/numerics/mpq.h"
 #include "kernel/environment.h"
+#include "kernel/expr_maps.h"
 #include "library/type_context.h"
 #include "library/num.h"
 #include "library/class_instance_resolution.h"
-#include "util/numerics/mpq.h"
-#include <unordered_map>
-#include <string>
 
 namespace lean {
+/** \brief Procedure for normalizing numerals.
+    A norm_num_context can (and should) be reused for many expressions. It caches the
+    class instances it synthesizes and the normal forms (and proofs) of the subterms it visits.
 
-struct hash_name {
-    size_t operator() (const name &n) const {
-        return std::hash<std::string>()(n.to_string());
-    }
-};
-
+    \remark The cached instances depend on the local instances of the given type context.
+    So, the norm_num_context must not outlive the local instance configuration of \c type_ctx. */
 class norm_num_context {
     type_context & m_type_ctx;
     levels m_lvls;
+    expr_struct_map<expr>             m_instances; // (C.{m_lvls} A) -> instance of C for type A
+    expr_struct_map<pair<expr, expr>> m_cache;     // e -> (normal form of e, proof)
+    optional<expr> try_mk_instance(name const & cls, expr const & type);
+    expr mk_instance(name const & cls, expr const & type);
+    pair<expr, expr> mk_norm_core(expr const & e);
     pair<expr, expr> mk_norm_add(expr const &, expr const &);
     pair<expr, expr> mk_norm_add1(expr const &);
     pair<expr, expr> mk_norm_mul(expr const &, expr const &);
@@ -68,7 +71,6 @@ class norm_num_context {
     expr mk_norm_mul_div(expr &, expr &, expr &);
     expr mk_nonzero_prf(expr const & e);
     pair<expr, expr> get_type_and_arg_of_neg(expr &);
-    std::unordered_map<name, expr, hash_name> instances;
 
 public:
     norm_num_context(type_context & type_ctx): m_type_ctx(type_ctx) {}
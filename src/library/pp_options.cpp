@@ -103,6 +103,25 @@ static name * g_pp_goal_compact    = nullptr;
 static name * g_pp_goal_max_hyps   = nullptr;
 static name * g_pp_binder_types    = nullptr;
 static name * g_pp_all             = nullptr;
+static option_slot * g_pp_max_depth_slot       = nullptr;
+static option_slot * g_pp_max_steps_slot       = nullptr;
+static option_slot * g_pp_notation_slot        = nullptr;
+static option_slot * g_pp_implicit_slot        = nullptr;
+static option_slot * g_pp_coercions_slot       = nullptr;
+static option_slot * g_pp_universes_slot       = nullptr;
+static option_slot * g_pp_full_names_slot      = nullptr;
+static option_slot * g_pp_private_names_slot   = nullptr;
+static option_slot * g_pp_metavar_args_slot    = nullptr;
+static option_slot * g_pp_purify_metavars_slot = nullptr;
+static option_slot * g_pp_purify_locals_slot   = nullptr;
+static option_slot * g_pp_beta_slot            = nullptr;
+static option_slot * g_pp_numerals_slot        = nullptr;
+static option_slot * g_pp_abbreviations_slot   = nullptr;
+static option_slot * g_pp_preterm_slot         = nullptr;
+static option_slot * g_pp_goal_compact_slot    = nullptr;
+static option_slot * g_pp_goal_max_hyps_slot   = nullptr;
+static option_slot * g_pp_binder_types_slot    = nullptr;
+static option_slot * g_pp_all_slot             = nullptr;
 static list<options> * g_distinguishing_pp_options = nullptr;
 
 void initialize_pp_options() {
@@ -126,47 +145,47 @@ void initialize_pp_options() {
     g_pp_goal_max_hyps   = new name{"pp", "goal", "max_hypotheses"};
     g_pp_binder_types    = new name{"pp", "binder_types"};
 
-    register_unsigned_option(*g_pp_max_depth, LEAN_DEFAULT_PP_MAX_DEPTH,
-                             "(pretty printer) maximum expression depth, after that it will use ellipsis");
-    register_unsigned_option(*g_pp_max_steps, LEAN_DEFAULT_PP_MAX_STEPS,
-                             "(pretty printer) maximum number of visited expressions, after that it will use ellipsis");
-    register_bool_option(*g_pp_notation,  LEAN_DEFAULT_PP_NOTATION,
-                         "(pretty printer) disable/enable notation (infix, mixfix, postfix operators and unicode characters)");
-    register_bool_option(*g_pp_implicit,  LEAN_DEFAULT_PP_IMPLICIT,
-                         "(pretty printer) display implicit parameters");
-    register_bool_option(*g_pp_coercions,  LEAN_DEFAULT_PP_COERCIONS,
-                         "(pretty printer) display coercionss");
-    register_bool_option(*g_pp_universes,  LEAN_DEFAULT_PP_UNIVERSES,
-                         "(pretty printer) display universes");
-    register_bool_option(*g_pp_full_names,  LEAN_DEFAULT_PP_FULL_NAMES,
-                         "(pretty printer) display fully qualified names");
-    register_bool_option(*g_pp_private_names,  LEAN_DEFAULT_PP_PRIVATE_NAMES,
-                         "(pretty printer) display internal names assigned to private declarations");
-    register_bool_option(*g_pp_metavar_args,  LEAN_DEFAULT_PP_METAVAR_ARGS,
-                         "(pretty printer) display metavariable arguments");
-    register_bool_option(*g_pp_purify_metavars, LEAN_DEFAULT_PP_PURIFY_METAVARS,
-                         "(pretty printer) rename internal metavariable names (with \"user-friendly\" ones) "
-                         "before pretty printing");
-    register_bool_option(*g_pp_purify_locals, LEAN_DEFAULT_PP_PURIFY_LOCALS,
-                         "(pretty printer) rename local names to avoid name capture, "
-                         "before pretty printing");
-    register_bool_option(*g_pp_beta,  LEAN_DEFAULT_PP_BETA,
-                         "(pretty printer) apply beta-reduction when pretty printing");
-    register_bool_option(*g_pp_numerals, LEAN_DEFAULT_PP_NUMERALS,
-                         "(pretty printer) display nat/num numerals in decimal notation");
-    register_bool_option(*g_pp_abbreviations, LEAN_DEFAULT_PP_ABBREVIATIONS,
-                         "(pretty printer) display abbreviations (i.e., revert abbreviation expansion when pretty printing)");
-    register_bool_option(*g_pp_preterm, LEAN_DEFAULT_PP_PRETERM,
-                         "(pretty printer) assume the term is a preterm (i.e., a term before elaboration)");
-    register_bool_option(*g_pp_goal_compact, LEAN_DEFAULT_PP_GOAL_COMPACT,
-                         "(pretty printer) try to display goal in a single line when possible");
-    register_unsigned_option(*g_pp_goal_max_hyps, LEAN_DEFAULT_PP_GOAL_MAX_HYPS,
-                             "(pretty printer) maximum number of hypotheses to be displayed");
-    register_bool_option(*g_pp_binder_types, LEAN_DEFAULT_PP_BINDER_TYPES,
-                         "(pretty printer) display types of lambda and Pi parameters");
-    register_bool_option(*g_pp_all, LEAN_DEFAULT_PP_ALL,
-                         "(pretty printer) display coercions, implicit parameters, fully qualified names, universes, "
-                         "and disable abbreviations, beta reduction and notation during pretty printing");
+    g_pp_max_depth_slot = new option_slot(register_unsigned_option(*g_pp_max_depth, LEAN_DEFAULT_PP_MAX_DEPTH,
+                                                                   "(pretty printer) maximum expression depth, after that it will use ellipsis"));
+    g_pp_max_steps_slot = new option_slot(register_unsigned_option(*g_pp_max_steps, LEAN_DEFAULT_PP_MAX_STEPS,
+                                                                   "(pretty printer) maximum number of visited expressions, after that it will use ellipsis"));
+    g_pp_notation_slot = new option_slot(register_bool_option(*g_pp_notation,  LEAN_DEFAULT_PP_NOTATION,
+                                                              "(pretty printer) disable/enable notation (infix, mixfix, postfix operators and unicode characters)"));
+    g_pp_implicit_slot = new option_slot(register_bool_option(*g_pp_implicit,  LEAN_DEFAULT_PP_IMPLICIT,
+                                                              "(pretty printer) display implicit parameters"));
+    g_pp_coercions_slot = new option_slot(register_bool_option(*g_pp_coercions,  LEAN_DEFAULT_PP_COERCIONS,
+                                                               "(pretty printer) display coercionss"));
+    g_pp_universes_slot = new option_slot(register_bool_option(*g_pp_universes,  LEAN_DEFAULT_PP_UNIVERSES,
+                                                               "(pretty printer) display universes"));
+    g_pp_full_names_slot = new option_slot(register_bool_option(*g_pp_full_names,  LEAN_DEFAULT_PP_FULL_NAMES,
+                                                                "(pretty printer) display fully qualified names"));
+    g_pp_private_names_slot = new option_slot(register_bool_option(*g_pp_private_names,  LEAN_DEFAULT_PP_PRIVATE_NAMES,
+                                                                   "(pretty printer) display internal names assigned to private declarations"));
+    g_pp_metavar_args_slot = new option_slot(register_bool_option(*g_pp_metavar_args,  LEAN_DEFAULT_PP_METAVAR_ARGS,
+                                                                  "(pretty printer) display metavariable arguments"));
+    g_pp_purify_metavars_slot = new option_slot(register_bool_option(*g_pp_purify_metavars, LEAN_DEFAULT_PP_PURIFY_METAVARS,
+                                                                     "(pretty printer) rename internal metavariable names (with \"user-friendly\" ones) "
+                                                                     "before pretty printing"));
+    g_pp_purify_locals_slot = new option_slot(register_bool_option(*g_pp_purify_locals, LEAN_DEFAULT_PP_PURIFY_LOCALS,
+                                                                   "(pretty printer) rename local names to avoid name capture, "
+                                                                   "before pretty printing"));
+    g_pp_beta_slot = new option_slot(register_bool_option(*g_pp_beta,  LEAN_DEFAULT_PP_BETA,
+                                                          "(pretty printer) apply beta-reduction when pretty printing"));
+    g_pp_numerals_slot = new option_slot(register_bool_option(*g_pp_numerals, LEAN_DEFAULT_PP_NUMERALS,
+                                                              "(pretty printer) display nat/num numerals in decimal notation"));
+    g_pp_abbreviations_slot = new option_slot(register_bool_option(*g_pp_abbreviations, LEAN_DEFAULT_PP_ABBREVIATIONS,
+                                                                   "(pretty printer) display abbreviations (i.e., revert abbreviation expansion when pretty printing)"));
+    g_pp_preterm_slot = new option_slot(register_bool_option(*g_pp_preterm, LEAN_DEFAULT_PP_PRETERM,
+                                                             "(pretty printer) assume the term is a preterm (i.e., a term before elaboration)"));
+    g_pp_goal_compact_slot = new option_slot(register_bool_option(*g_pp_goal_compact, LEAN_DEFAULT_PP_GOAL_COMPACT,
+                                                                  "(pretty printer) try to display goal in a single line when possible"));
+    g_pp_goal_max_hyps_slot = new option_slot(register_unsigned_option(*g_pp_goal_max_hyps, LEAN_DEFAULT_PP_GOAL_MAX_HYPS,
+                                                                       "(pretty printer) maximum number of hypotheses to be displayed"));
+    g_pp_binder_types_slot = new option_slot(register_bool_option(*g_pp_binder_types, LEAN_DEFAULT_PP_BINDER_TYPES,
+                                                                  "(pretty printer) display types of lambda and Pi parameters"));
+    g_pp_all_slot = new option_slot(register_bool_option(*g_pp_all, LEAN_DEFAULT_PP_ALL,
+                                                         "(pretty printer) display coercions, implicit parameters, fully qualified names, universes, "
+                                                         "and disable abbreviations, beta reduction and notation during pretty printing"));
     options universes_true(*g_pp_universes, true);
     options full_names_true(*g_pp_full_names, true);
     options implicit_true(*g_pp_implicit, true);
@@ -198,6 +217,25 @@ void finalize_pp_options() {
     delete g_pp_goal_compact;
     delete g_pp_goal_max_hyps;
     delete g_pp_all;
+    delete g_pp_max_depth_slot;
+    delete g_pp_max_steps_slot;
+    delete g_pp_notation_slot;
+    delete g_pp_implicit_slot;
+    delete g_pp_coercions_slot;
+    delete g_pp_universes_slot;
+    delete g_pp_full_names_slot;
+    delete g_pp_private_names_slot;
+    delete g_pp_metavar_args_slot;
+    delete g_pp_purify_metavars_slot;
+    delete g_pp_purify_locals_slot;
+    delete g_pp_beta_slot;
+    delete g_pp_numerals_slot;
+    delete g_pp_abbreviations_slot;
+    delete g_pp_preterm_slot;
+    delete g_pp_goal_compact_slot;
+    delete g_pp_goal_max_hyps_slot;
+    delete g_pp_binder_types_slot;
+    delete g_pp_all_slot;
     delete g_distinguishing_pp_options;
 }
 
@@ -214,25 +252,25 @@ name const & get_pp_preterm_name() { return *g_pp_preterm; }
 name const & get_pp_numerals_name() { return *g_pp_numerals; }
 name const & get_pp_abbreviations_name() { return *g_pp_abbreviations; }
 
-unsigned get_pp_max_depth(options const & opts)       { return opts.get_unsigned(*g_pp_max_depth, LEAN_DEFAULT_PP_MAX_DEPTH); }
-unsigned get_pp_max_steps(options const & opts)       { return opts.get_unsigned(*g_pp_max_steps, LEAN_DEFAULT_PP_MAX_STEPS); }
-bool     get_pp_notation(options const & opts)        { return opts.get_bool(*g_pp_notation, LEAN_DEFAULT_PP_NOTATION); }
-bool     get_pp_implicit(options const & opts)        { return opts.get_bool(*g_pp_implicit, LEAN_DEFAULT_PP_IMPLICIT); }
-bool     get_pp_coercions(options const & opts)       { return opts.get_bool(*g_pp_coercions, LEAN_DEFAULT_PP_COERCIONS); }
-bool     get_pp_universes(options const & opts)       { return opts.get_bool(*g_pp_universes, LEAN_DEFAULT_PP_UNIVERSES); }
-bool     get_pp_full_names(options const & opts)      { return opts.get_bool(*g_pp_full_names, LEAN_DEFAULT_PP_FULL_NAMES); }
-bool     get_pp_private_names(options const & opts)   { return opts.get_bool(*g_pp_private_names, LEAN_DEFAULT_PP_PRIVATE_NAMES); }
-bool     get_pp_metavar_args(options const & opts)    { return opts.get_bool(*g_pp_metavar_args, LEAN_DEFAULT_PP_METAVAR_ARGS); }
-bool     get_pp_purify_metavars(options const & opts) { return opts.get_bool(*g_pp_purify_metavars, LEAN_DEFAULT_PP_PURIFY_METAVARS); }
-bool     get_pp_purify_locals(options const & opts)   { return opts.get_bool(*g_pp_purify_locals, LEAN_DEFAULT_PP_PURIFY_LOCALS); }
-bool     get_pp_beta(options const & opts)            { return opts.get_bool(*g_pp_beta, LEAN_DEFAULT_PP_BETA); }
-bool     get_pp_numerals(options const & opts)        { return opts.get_bool(*g_pp_numerals, LEAN_DEFAULT_PP_NUMERALS); }
-bool     get_pp_abbreviations(options const & opts)   { return opts.get_bool(*g_pp_abbreviations, LEAN_DEFAULT_PP_ABBREVIATIONS); }
-bool     get_pp_preterm(options const & opts)         { return opts.get_bool(*g_pp_preterm, LEAN_DEFAULT_PP_PRETERM); }
-bool     get_pp_goal_compact(options const & opts)    { return opts.get_bool(*g_pp_goal_compact, LEAN_DEFAULT_PP_GOAL_COMPACT); }
-unsigned get_pp_goal_max_hyps(options const & opts)   { return opts.get_unsigned(*g_pp_goal_max_hyps, LEAN_DEFAULT_PP_GOAL_MAX_HYPS); }
-bool     get_pp_binder_types(options const & opts)    { return opts.get_bool(*g_pp_binder_types, LEAN_DEFAULT_PP_BINDER_TYPES); }
-bool     get_pp_all(options const & opts)             { return opts.get_bool(*g_pp_all, LEAN_DEFAULT_PP_ALL); }
+unsigned get_pp_max_depth(options const & opts)       { return opts.get_unsigned(*g_pp_max_depth_slot, LEAN_DEFAULT_PP_MAX_DEPTH); }
+unsigned get_pp_max_steps(options const & opts)       { return opts.get_unsigned(*g_pp_max_steps_slot, LEAN_DEFAULT_PP_MAX_STEPS); }
+bool     get_pp_notation(options const & opts)        { return opts.get_bool(*g_pp_notation_slot, LEAN_DEFAULT_PP_NOTATION); }
+bool     get_pp_implicit(options const & opts)        { return opts.get_bool(*g_pp_implicit_slot, LEAN_DEFAULT_PP_IMPLICIT); }
+bool     get_pp_coercions(options const & opts)       { return opts.get_bool(*g_pp_coercions_slot, LEAN_DEFAULT_PP_COERCIONS); }
+bool     get_pp_universes(options const & opts)       { return opts.get_bool(*g_pp_universes_slot, LEAN_DEFAULT_PP_UNIVERSES); }
+bool     get_pp_full_names(options const & opts)      { return opts.get_bool(*g_pp_full_names_slot, LEAN_DEFAULT_PP_FULL_NAMES); }
+bool     get_pp_private_names(options const & opts)   { return opts.get_bool(*g_pp_private_names_slot, LEAN_DEFAULT_PP_PRIVATE_NAMES); }
+bool     get_pp_metavar_args(options const & opts)    { return opts.get_bool(*g_pp_metavar_args_slot, LEAN_DEFAULT_PP_METAVAR_ARGS); }
+bool     get_pp_purify_metavars(options const & opts) { return opts.get_bool(*g_pp_purify_metavars_slot, LEAN_DEFAULT_PP_PURIFY_METAVARS); }
+bool     get_pp_purify_locals(options const & opts)   { return opts.get_bool(*g_pp_purify_locals_slot, LEAN_DEFAULT_PP_PURIFY_LOCALS); }
+bool     get_pp_beta(options const & opts)            { return opts.get_bool(*g_pp_beta_slot, LEAN_DEFAULT_PP_BETA); }
+bool     get_pp_numerals(options const & opts)        { return opts.get_bool(*g_pp_numerals_slot, LEAN_DEFAULT_PP_NUMERALS); }
+bool     get_pp_abbreviations(options const & opts)   { return opts.get_bool(*g_pp_abbreviations_slot, LEAN_DEFAULT_PP_ABBREVIATIONS); }
+bool     get_pp_preterm(options const & opts)         { return opts.get_bool(*g_pp_preterm_slot, LEAN_DEFAULT_PP_PRETERM); }
+bool     get_pp_goal_compact(options const & opts)    { return opts.get_bool(*g_pp_goal_compact_slot, LEAN_DEFAULT_PP_GOAL_COMPACT); }
+unsigned get_pp_goal_max_hyps(options const & opts)   { return opts.get_unsigned(*g_pp_goal_max_hyps_slot, LEAN_DEFAULT_PP_GOAL_MAX_HYPS); }
+bool     get_pp_binder_types(options const & opts)    { return opts.get_bool(*g_pp_binder_types_slot, LEAN_DEFAULT_PP_BINDER_TYPES); }
+bool     get_pp_all(options const & opts)             { return opts.get_bool(*g_pp_all_slot, LEAN_DEFAULT_PP_ALL); }
 
 list<options> const & get_distinguishing_pp_options() { return *g_distinguishing_pp_options; }
 }
@@ -339,6 +339,13 @@ public:
     static list<entry> const * get_entries(environment const & env, name const & n) {
         return get(env).m_entries_map.find(n);
     }
+    /** \brief Apply \c fn to the entries/attributes of every namespace */
+    template<typename F> static void for_each_entry(environment const & env, F && fn) {
+        get(env).m_entries_map.for_each([&](name const &, list<entry> const & es) {
+                for (entry const & e : es)
+                    fn(e);
+            });
+    }
 };
 
 template<typename Config>
@@ -4,11 +4,14 @@ Released under Apache 2.0 license as described in the file LICENSE.
 
 Author: Leonardo de Moura
 */
+#include <vector>
+#include "util/debug.h"
 #include "library/shared_environment.h"
 
 namespace lean {
-shared_environment::shared_environment() {}
-shared_environment::shared_environment(environment const & env):m_env(env) {}
+shared_environment::shared_environment():m_deferred(nullptr) {}
+shared_environment::shared_environment(environment const & env):m_env(env), m_deferred(nullptr) {}
+shared_environment::shared_environment(std::vector<update_fn> * deferred):m_deferred(deferred) {}
 
 environment shared_environment::get_environment() const {
     lock_guard<mutex> l(m_mutex);
@@ -16,21 +19,28 @@ environment shared_environment::get_environment() const {
 }
 
 void shared_environment::add(certified_declaration const & d) {
+    lean_assert(!m_deferred);
     lock_guard<mutex> l(m_mutex);
     m_env = m_env.add(d);
 }
 
 void shared_environment::add(declaration const & d) {
+    lean_assert(!m_deferred);
     lock_guard<mutex> l(m_mutex);
     m_env = m_env.add(d);
 }
 
 void shared_environment::replace(certified_declaration const & t) {
+    lean_assert(!m_deferred);
     lock_guard<mutex> l(m_mutex);
     m_env = m_env.replace(t);
 }
 
 void shared_environment::update(std::function<environment(environment const &)> const & f) {
+    if (m_deferred) {
+        m_deferred->push_back(f);
+        return;
+    }
     lock_guard<mutex> l(m_mutex);
     m_env = f(m_env);
 }
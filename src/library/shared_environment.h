@@ -6,6 +6,7 @@ Author: Leonardo de Moura
 */
 #pragma once
 #include <functional>
+#include <vector>
 #include "util/shared_mutex.h"
 #include "kernel/environment.h"
 
@@ -13,8 +14,13 @@ namespace lean {
 /** \brief Auxiliary object used when multiple threads are trying to populate the same environment. */
 class shared_environment {
     friend struct import_modules_fn;
+    typedef std::function<environment(environment const &)> update_fn;
     environment          m_env;
     mutable mutex        m_mutex;
+    /** \brief When not nullptr, #update stores the given functions here instead of applying them.
+        The module importer uses this feature to decode objects before the environment they update is available. */
+    std::vector<update_fn> * m_deferred;
+    shared_environment(std::vector<update_fn> * deferred);
     /**
         \brief Add declaration that was not type checked.
         The method throws an exception if trust_level() == 0
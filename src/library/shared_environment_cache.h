@@ -0,0 +1,84 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "util/thread.h"
+#include "util/optional.h"
+#include "kernel/environment.h"
+
+#ifndef LEAN_SHARED_ENVIRONMENT_CACHE_NUM_ENVS
+#define LEAN_SHARED_ENVIRONMENT_CACHE_NUM_ENVS 8
+#endif
+
+namespace lean {
+/** \brief Thread safe mapping from K to T shared by all threads.
+
+    It is used to cache information about closed terms (e.g., function constants) that
+    is determined by the environment. So, different tactics (and threads) working on the same
+    environment do not have to recompute it.
+
+    We keep a table for each one of the last LEAN_SHARED_ENVIRONMENT_CACHE_NUM_ENVS environments
+    used to access the cache. The tables for other environments are discarded. */
+template<typename K, typename T, typename HASH, typename EQ = std::equal_to<K>>
+class shared_environment_cache {
+    struct table {
+        environment                         m_env;
+        std::unordered_map<K, T, HASH, EQ>  m_map;
+        table(environment const & env):m_env(env) {}
+    };
+    mutex              m_mutex;
+    std::vector<table> m_tables;
+    unsigned           m_next{0}; // next table to be replaced
+
+    static bool compatible(environment const & env1, environment const & env2) {
+        return env1.is_descendant(env2) && env2.is_descendant(env1);
+    }
+
+    table * find_table(environment const & env) {
+        for (table & t : m_tables) {
+            if (compatible(t.m_env, env))
+                return &t;
+        }
+        return nullptr;
+    }
+
+public:
+    optional<T> find(environment const & env, K const & k) {
+        lock_guard<mutex> lock(m_mutex);
+        if (table * t = find_table(env)) {
+            auto it = t->m_map.find(k);
+            if (it != t->m_map.end())
+                return optional<T>(it->second);
+        }
+        return optional<T>();
+    }
+
+    void insert(environment const & env, K const & k, T const & v) {
+        lock_guard<mutex> lock(m_mutex);
+        table * t = find_table(env);
+        if (!t) {
+            if (m_tables.size() < LEAN_SHARED_ENVIRONMENT_CACHE_NUM_ENVS) {
+                m_tables.emplace_back(env);
+                t = &m_tables.back();
+            } else {
+                t = &m_tables[m_next];
+                *t = table(env);
+                m_next = (m_next + 1) % LEAN_SHARED_ENVIRONMENT_CACHE_NUM_ENVS;
+            }
+        }
+        t->m_map.insert(mk_pair(k, v));
+    }
+
+    void clear() {
+        lock_guard<mutex> lock(m_mutex);
+        m_tables.clear();
+        m_next = 0;
+    }
+};
+}
@@ -12,14 +12,15 @@ namespace lean {
 using inductive::inductive_normalizer_extension;
 
 /** \brief Create standard Lean environment */
-environment mk_environment(unsigned trust_lvl) {
+environment mk_environment(unsigned trust_lvl, bool whnf_machine) {
     environment env = environment(trust_lvl,
                                   true /* Type.{0} is proof irrelevant */,
                                   true /* Eta */,
                                   true /* Type.{0} is impredicative */,
                                   /* builtin support for inductive */
                                   compose(std::unique_ptr<normalizer_extension>(new inductive_normalizer_extension()),
-                                          std::unique_ptr<normalizer_extension>(new quotient_normalizer_extension())));
+                                          std::unique_ptr<normalizer_extension>(new quotient_normalizer_extension())),
+                                  whnf_machine);
     return set_unifier_plugin(env, mk_inductive_unifier_plugin());
 }
 }
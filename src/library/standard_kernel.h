@@ -9,5 +9,5 @@ Author: Leonardo de Moura
 
 namespace lean {
 /** \brief Create standard Lean environment */
-environment mk_environment(unsigned trust_lvl = 0);
+environment mk_environment(unsigned trust_lvl = 0, bool whnf_machine = false);
 }
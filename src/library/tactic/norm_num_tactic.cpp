@@ -34,13 +34,16 @@ tactic norm_num_tactic() {
             try {
                 tmp_type_context ctx(env, ios.get_options());
                 ctx.set_local_instances(to_list(hyps));
-                pair<expr, expr> p = mk_norm_num(ctx, lhs);
+                // the same context is used for both sides, so class instances and the
+                // normal forms of common subterms are only computed once
+                norm_num_context nctx(ctx);
+                pair<expr, expr> p = nctx.mk_norm(lhs);
                 expr new_lhs = p.first;
                 expr new_lhs_pr  = p.second;
-                pair<expr, expr> p2 = mk_norm_num(ctx, rhs);
+                pair<expr, expr> p2 = nctx.mk_norm(rhs);
                 expr new_rhs = p2.first;
                 expr new_rhs_pr = p2.second;
-                mpq v_lhs = mpq_of_expr(ctx, new_lhs), v_rhs = mpq_of_expr(ctx, new_rhs);
+                mpq v_lhs = nctx.mpq_of_expr(new_lhs), v_rhs = nctx.mpq_of_expr(new_rhs);
                 if (v_lhs == v_rhs) {
                     type_checker tc(env);
                     expr g_prf = mk_trans(tc, new_lhs_pr, mk_symm(tc, new_rhs_pr));
@@ -1304,6 +1304,35 @@ class rewrite_fn {
             return pattern == f;
     }
 
+    // Return true iff the matcher (i.e., m_mplugin) cannot reduce \c t using whnf.
+    bool is_rigid(expr const & t) const {
+        expr const & f = get_app_fn(t);
+        switch (f.kind()) {
+        case expr_kind::Local: case expr_kind::Sort: case expr_kind::Pi:
+            return true;
+        case expr_kind::Lambda:
+            return !is_app(t);
+        case expr_kind::Constant:
+            return
+                !m_matcher_tc->is_delta(f) &&
+                !m_env.norm_ext().is_recursor(m_env, const_name(f)) &&
+                !m_env.norm_ext().is_builtin(m_env, const_name(f));
+        case expr_kind::Var: case expr_kind::Meta: case expr_kind::Macro:
+        case expr_kind::App: case expr_kind::Let:
+            return false;
+        }
+        lean_unreachable();
+    }
+
+    static bool is_same_head(expr const & f, expr const & g) {
+        if (is_constant(f) && is_constant(g))
+            return const_name(f) == const_name(g);
+        else if (is_local(f) && is_local(g))
+            return mlocal_name(f) == mlocal_name(g);
+        else
+            return false;
+    }
+
     // Search for \c pattern in \c e. If \c t is a match, then try to unify the type of the rule
     // in the rewrite step \c orig_elem with \c t.
     // When successful, this method returns the target \c t, the fully elaborated rule \c r,
@@ -1311,13 +1340,20 @@ class rewrite_fn {
     //
     // \remark is_goal == true if \c e is the type of a goal. Otherwise, it is assumed to be the type
     // of a hypothesis. This flag affects the equality proof built by this method.
+    //
+    // \remark If the head symbol of \c pattern is a rigid constant or local, then we only try to match
+    // subterms with the same head symbol, or the ones that may be reduced by the matcher.
     find_result find_target(expr const & e, expr const & pattern, expr const & orig_elem, bool is_goal) {
         find_result result;
+        expr const & p_fn = get_app_fn(pattern);
+        bool use_head     = !m_keyed && (is_constant(p_fn) || is_local(p_fn)) && is_rigid(pattern);
         for_each(e, [&](expr const & t, unsigned) {
                 if (result)
                     return false; // stop search
                 if (closed(t)) {
                     lean_assert(std::all_of(m_esubst.begin(), m_esubst.end(), [&](optional<expr> const & e) { return !e; }));
+                    if (use_head && !is_same_head(p_fn, get_app_fn(t)) && is_rigid(t))
+                        return true; // t cannot be matched, but its subterms may
                     bool r;
                     if (m_keyed) {
                         r = compare_head(pattern, t);
@@ -140,4 +140,28 @@ void tmp_type_context::commit() {
     lean_assert(!m_scopes.empty());
     m_scopes.pop_back();
 }
+
+default_tmp_type_context_pool::~default_tmp_type_context_pool() {
+    for (tmp_type_context * ctx : m_pool)
+        delete ctx;
+}
+
+tmp_type_context * default_tmp_type_context_pool::mk_tmp_type_context() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        if (!m_pool.empty()) {
+            tmp_type_context * r = m_pool.back();
+            m_pool.pop_back();
+            return r;
+        }
+    }
+    return new tmp_type_context(m_env, m_options);
+}
+
+void default_tmp_type_context_pool::recycle_tmp_type_context(tmp_type_context * tmp_tctx) {
+    lean_assert(tmp_tctx);
+    tmp_tctx->clear();
+    lock_guard<mutex> lock(m_mutex);
+    m_pool.push_back(tmp_tctx);
+}
 }
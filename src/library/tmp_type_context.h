@@ -6,6 +6,7 @@ Author: Leonardo de Moura
 */
 #pragma once
 #include <vector>
+#include "util/thread.h"
 #include "library/type_context.h"
 #include "library/reducible.h"
 
@@ -99,15 +100,20 @@ public:
     virtual ~tmp_type_context_pool() {}
 };
 
+/** \brief Pool of \c tmp_type_context objects for the given environment and options.
+    Recycled objects are reused (and keep their caches). The pool can be shared by different threads. */
 class default_tmp_type_context_pool : public tmp_type_context_pool {
-    environment m_env;
-    options     m_options;
+    environment                     m_env;
+    options                         m_options;
+    mutex                           m_mutex;
+    std::vector<tmp_type_context *> m_pool;
 public:
     default_tmp_type_context_pool(environment const & env, options const & o):
         m_env(env), m_options(o) {}
+    virtual ~default_tmp_type_context_pool();
 
-    virtual tmp_type_context * mk_tmp_type_context() override { return new tmp_type_context(m_env, m_options); }
-    virtual void recycle_tmp_type_context(tmp_type_context * tmp_tctx) override { delete tmp_tctx; }
+    virtual tmp_type_context * mk_tmp_type_context() override;
+    virtual void recycle_tmp_type_context(tmp_type_context * tmp_tctx) override;
 };
 
 }
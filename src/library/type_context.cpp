@@ -7,12 +7,14 @@ Author: Leonardo de Moura
 #include <vector>
 #include <algorithm>
 #include "util/interrupt.h"
+#include "util/stats.h"
 #include "util/sexpr/option_declarations.h"
 #include "kernel/instantiate.h"
 #include "kernel/abstract.h"
 #include "kernel/for_each_fn.h"
 #include "kernel/replace_fn.h"
 #include "kernel/inductive/inductive.h"
+#include "kernel/whnf_machine.h"
 #include "library/trace.h"
 #include "library/util.h"
 #include "library/projection.h"
@@ -34,11 +36,20 @@ Author: Leonardo de Moura
 #define LEAN_DEFAULT_CLASS_TRANS_INSTANCES true
 #endif
 
+#ifndef LEAN_DEFAULT_WHNF_MACHINE
+#define LEAN_DEFAULT_WHNF_MACHINE false
+#endif
+
 namespace lean {
+static stats_id g_whnf_stats                 = 0;
+static stats_id g_infer_cache_hit_stats      = 0;
+static stats_id g_instance_stats             = 0;
+static stats_id g_instance_cache_hit_stats   = 0;
 static name * g_tmp_prefix                   = nullptr;
 static name * g_internal_prefix              = nullptr;
 static name * g_class_instance_max_depth     = nullptr;
 static name * g_class_trans_instances        = nullptr;
+static name * g_whnf_machine                 = nullptr;
 
 unsigned get_class_instance_max_depth(options const & o) {
     return o.get_unsigned(*g_class_instance_max_depth, LEAN_DEFAULT_CLASS_INSTANCE_MAX_DEPTH);
@@ -48,6 +59,10 @@ bool get_class_trans_instances(options const & o) {
     return o.get_bool(*g_class_trans_instances, LEAN_DEFAULT_CLASS_TRANS_INSTANCES);
 }
 
+bool get_whnf_machine(options const & o) {
+    return o.get_bool(*g_whnf_machine, LEAN_DEFAULT_WHNF_MACHINE);
+}
+
 struct type_context::ext_ctx : public extension_context {
     type_context & m_owner;
 
@@ -84,6 +99,7 @@ type_context::type_context(environment const & env, options const & o, bool mult
     // TODO(Leo): use compilation options for setting config
     m_ci_max_depth       = 32;
     m_ci_trans_instances = true;
+    m_whnf_machine       = LEAN_DEFAULT_WHNF_MACHINE;
     update_options(o);
 }
 
@@ -206,11 +222,11 @@ optional<expr> type_context::reduce_projection(expr const & e) {
 optional<expr> type_context::norm_ext(expr const & e) {
     if (auto r = reduce_projection(e)) {
         return r;
-    } else if (auto r = m_env.norm_ext()(e, *m_ext_ctx)) {
-        return some_expr(r->first);
-    } else {
-        return none_expr();
+    } else if (auto ext = m_norm_ext_index.find(m_env, e)) {
+        if (auto r = (*ext)(e, *m_ext_ctx))
+            return some_expr(r->first);
     }
+    return none_expr();
 }
 
 expr type_context::whnf_core(expr const & e) {
@@ -220,6 +236,8 @@ expr type_context::whnf_core(expr const & e) {
     case expr_kind::Pi:  case expr_kind::Constant: case expr_kind::Lambda:
         return e;
     case expr_kind::Let:
+        if (m_whnf_machine)
+            return whnf_core(whnf_beta_zeta(e));
         return whnf_core(instantiate(let_body(e), let_value(e)));
     case expr_kind::Macro:
         if (auto m = expand_macro(e))
@@ -228,6 +246,11 @@ expr type_context::whnf_core(expr const & e) {
             return e;
         break;
     case expr_kind::App: {
+        if (m_whnf_machine) {
+            expr new_e = whnf_beta_zeta(e);
+            if (!is_eqp(new_e, e))
+                return whnf_core(new_e);
+        }
         buffer<expr> args;
         expr f0 = get_app_rev_args(e, args);
         expr f = whnf_core(f0);
@@ -315,6 +338,7 @@ expr type_context::whnf(expr const & e) {
         break;
     }
 
+    stats_inc(g_whnf_stats);
     expr t = e;
     while (true) {
         expr t1 = whnf_core(t, 0);
@@ -1196,8 +1220,10 @@ expr type_context::infer(expr const & e) {
     lean_assert(!is_var(e));
     lean_assert(closed(e));
     auto it = m_infer_cache.find(e);
-    if (it != m_infer_cache.end())
+    if (it != m_infer_cache.end()) {
+        stats_inc(g_infer_cache_hit_stats);
         return it->second;
+    }
     expr r;
     switch (e.kind()) {
     case expr_kind::Local:
@@ -1561,6 +1587,8 @@ bool type_context::update_options(options const & opts) {
     }
     m_ci_max_depth        = max_depth;
     m_ci_trans_instances  = trans_instances;
+    // the machine only changes how terms are reduced, not the results
+    m_whnf_machine        = get_whnf_machine(o);
     return r;
 }
 
@@ -1829,10 +1857,12 @@ optional<expr> type_context::ensure_no_meta(optional<expr> r) {
 }
 
 optional<expr> type_context::mk_class_instance_core(expr const & type) {
+    stats_inc(g_instance_stats);
     if (!m_ci_multiple_instances) {
         /* We do not cache results when multiple instances have to be generated. */
         auto it = m_ci_cache.find(type);
         if (it != m_ci_cache.end()) {
+            stats_inc(g_instance_cache_hit_stats);
             /* instance/failure is already cached */
             lean_trace("class_instances",
                        if (it->second)
@@ -2146,13 +2176,23 @@ void initialize_type_context() {
     g_internal_prefix = new name(name::mk_internal_unique_name());
     register_trace_class("class_instances");
     register_trace_class(name({"type_context", "unification_hint"}));
+    g_whnf_stats               = register_stats_counter(name{"type_context", "whnf"}, "number of (nontrivial) whnf calls");
+    g_infer_cache_hit_stats    = register_stats_counter(name{"type_context", "infer_cache_hit"},
+                                                        "number of infer type cache hits");
+    g_instance_stats           = register_stats_counter(name{"class_instances", "queries"},
+                                                        "number of type class resolution problems");
+    g_instance_cache_hit_stats = register_stats_counter(name{"class_instances", "cache_hit"},
+                                                        "number of type class resolution problems solved using the cache");
     g_class_instance_max_depth     = new name{"class", "instance_max_depth"};
     g_class_trans_instances        = new name{"class", "trans_instances"};
+    g_whnf_machine                 = new name("whnf_machine");
     register_unsigned_option(*g_class_instance_max_depth, LEAN_DEFAULT_CLASS_INSTANCE_MAX_DEPTH,
                              "(class) max allowed depth in class-instance resolution");
     register_bool_option(*g_class_trans_instances,  LEAN_DEFAULT_CLASS_TRANS_INSTANCES,
                          "(class) use automatically derived instances from the transitive closure of "
                          "the structure instance graph");
+    register_bool_option(*g_whnf_machine, LEAN_DEFAULT_WHNF_MACHINE,
+                         "use an abstract machine for beta/let reduction in the elaborator");
 }
 
 void finalize_type_context() {
@@ -2160,5 +2200,6 @@ void finalize_type_context() {
     delete g_internal_prefix;
     delete g_class_instance_max_depth;
     delete g_class_trans_instances;
+    delete g_whnf_machine;
 }
 }
@@ -19,6 +19,7 @@ Author: Leonardo de Moura
 namespace lean {
 unsigned get_class_instance_max_depth(options const & o);
 bool get_class_trans_instances(options const & o);
+bool get_whnf_machine(options const & o);
 
 /** \brief Type inference, normalization and definitional equality.
     It is similar to the kernel type checker but it also supports unification variables.
@@ -116,6 +117,7 @@ class type_context : public abstract_type_context {
     // postponed universe constraints
     std::vector<pair<level, level>> m_postponed;
     name_map<projection_info>       m_proj_info;
+    normalizer_extension_index      m_norm_ext_index;
     bool                            m_in_is_def_eq{false};
 
     // Internal (configuration) options for customers
@@ -270,6 +272,7 @@ class type_context : public abstract_type_context {
     unsigned                        m_ci_max_depth;
     bool                            m_ci_trans_instances;
     bool                            m_ci_trace_instances;
+    bool                            m_whnf_machine;
 
     optional<name> constant_is_class(expr const & e);
     optional<name> is_full_class(expr type);
@@ -309,6 +312,7 @@ public:
     virtual ~type_context();
 
     void set_local_instances(list<expr> const & insts);
+    bool has_local_instances() const { return !m_ci_local_instances.empty(); }
 
     virtual environment const & env() const override { return m_env; }
 
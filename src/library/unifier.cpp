@@ -15,6 +15,7 @@ Author: Leonardo de Moura
 #include "util/lbool.h"
 #include "util/flet.h"
 #include "util/fresh_name.h"
+#include "util/stats.h"
 #include "util/sexpr/option_declarations.h"
 #include "kernel/for_each_fn.h"
 #include "kernel/abstract.h"
@@ -61,6 +62,9 @@ static name * g_unifier_expensive_classes       = nullptr;
 static name * g_unifier_conservative            = nullptr;
 static name * g_unifier_nonchronological        = nullptr;
 static name * g_unifier_normalizer_max_steps    = nullptr;
+static stats_id g_case_split_stats              = 0;
+static stats_id g_conflict_stats                = 0;
+static stats_id g_num_steps_stats               = 0;
 
 unsigned get_unifier_max_steps(options const & opts) {
     return opts.get_unsigned(*g_unifier_max_steps, LEAN_DEFAULT_UNIFIER_MAX_STEPS);
@@ -1261,7 +1265,12 @@ struct unifier_fn {
         return true;
     }
 
+    ~unifier_fn() {
+        stats_record(g_num_steps_stats, m_num_steps);
+    }
+
     void add_case_split(std::unique_ptr<case_split> && cs) {
+        stats_inc(g_case_split_stats);
         m_case_splits.push_back(std::move(cs));
     }
 
@@ -1282,6 +1291,7 @@ struct unifier_fn {
 
     bool resolve_conflict() {
         lean_assert(in_conflict());
+        stats_inc(g_conflict_stats);
         while (!m_case_splits.empty()) {
             check_system();
             justification conflict = *m_conflict;
@@ -1457,13 +1467,24 @@ struct unifier_fn {
 
        \remark This step is only performed at process_next.
        Moreover, we only do it when the "major premise" of both projections is not a constructor.
+
+       \remark If the projection is a coercion, we also consider the case-split where it is unfolded.
+       The coercions inserted by the elaborator are compositions (e.g., (to_fun (to_pmap f) a)), and
+       the major premise of one of them may only reduce to a constructor after delta-reduction
+       (e.g., (to_fun (pcompose g h) a)).
     */
     bool process_same_projection_projection(constraint const & c) {
         lean_assert(is_same_projection_projection(c));
         buffer<expr> lhs_args, rhs_args;
         expr const & f_lhs = get_app_args(cnstr_lhs_expr(c), lhs_args);
         expr const & f_rhs = get_app_args(cnstr_rhs_expr(c), rhs_args);
-        justification const & j = c.get_justification();
+        justification j = c.get_justification();
+        if (m_config.m_kind == unifier_kind::Liberal && lhs_args.size() == rhs_args.size() &&
+            is_coercion(m_env, f_lhs)) {
+            justification a = mk_assumption_justification(m_next_assumption_idx);
+            add_case_split(std::unique_ptr<case_split>(new delta_unfold_case_split(*this, j, c)));
+            j = mk_composite1(j, a);
+        }
         return process_levels(const_levels(f_lhs), const_levels(f_rhs), j) && process_args(lhs_args, rhs_args, j);
     }
 
@@ -2842,6 +2863,9 @@ unify_result_seq unify(environment const & env, expr const & lhs, expr const & r
 
 void initialize_unifier() {
     register_trace_class(name{"unifier"});
+    g_case_split_stats             = register_stats_counter(name{"unifier", "case_splits"}, "number of case splits in the unifier");
+    g_conflict_stats               = register_stats_counter(name{"unifier", "conflicts"}, "number of conflicts in the unifier");
+    g_num_steps_stats              = register_stats_histogram(name{"unifier", "steps"}, "number of steps per unification problem");
     g_unifier_max_steps            = new name{"unifier", "max_steps"};
     g_unifier_normalizer_max_steps = new name{"unifier", "normalizer_max_steps"};
     g_unifier_expensive_classes    = new name{"unifier", "expensive_classes"};
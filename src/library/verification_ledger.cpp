@@ -0,0 +1,165 @@
+/*
+Copyright (c) 2015 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <string>
+#include <sstream>
+#include "util/sstream.h"
+#include "util/exception.h"
+#include "util/name_set.h"
+#include "util/sha256.h"
+#include "kernel/environment.h"
+#include "kernel/for_each_fn.h"
+#include "library/kernel_serializer.h"
+#include "library/verification_ledger.h"
+
+#ifndef LEAN_LEDGER_HEADER
+#define LEAN_LEDGER_HEADER "lean-verification-ledger-2"
+#endif
+
+namespace lean {
+bool verification_ledger::contains(ledger_key const & k) const {
+    lock_guard<mutex> lc(m_mutex);
+    return m_keys.find(k) != m_keys.end();
+}
+
+void verification_ledger::add(ledger_key const & k) {
+    lock_guard<mutex> lc(m_mutex);
+    if (m_keys.insert(k).second)
+        m_num_new++;
+}
+
+unsigned verification_ledger::get_num_new() const {
+    lock_guard<mutex> lc(m_mutex);
+    return m_num_new;
+}
+
+void verification_ledger::save(std::ostream & out) const {
+    lock_guard<mutex> lc(m_mutex);
+    out << LEAN_LEDGER_HEADER << "\n";
+    for (ledger_key const & k : m_keys)
+        out << to_hex(k) << "\n";
+}
+
+static int hex_digit_value(char c) {
+    if ('0' <= c && c <= '9')
+        return c - '0';
+    else if ('a' <= c && c <= 'f')
+        return c - 'a' + 10;
+    else
+        return -1;
+}
+
+void verification_ledger::load(std::istream & in) {
+    lock_guard<mutex> lc(m_mutex);
+    std::string header;
+    if (!std::getline(in, header))
+        return; // empty ledger
+    if (header != LEAN_LEDGER_HEADER)
+        throw exception("invalid verification ledger, unexpected header");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty())
+            continue;
+        if (line.size() != 64)
+            throw exception(sstream() << "invalid verification ledger entry '" << line << "'");
+        ledger_key k(32, '\0');
+        for (unsigned i = 0; i < 32; i++) {
+            int d1 = hex_digit_value(line[2*i]);
+            int d2 = hex_digit_value(line[2*i+1]);
+            if (d1 < 0 || d2 < 0)
+                throw exception(sstream() << "invalid verification ledger entry '" << line << "'");
+            k[i] = static_cast<char>(d1 * 16 + d2);
+        }
+        m_keys.insert(k);
+    }
+    m_num_new = 0;
+}
+
+/** \brief Add the kernel configuration to \c h. Declarations checked by a kernel with a different
+    configuration (e.g., the standard and HoTT kernels) must not share ledger entries. */
+static void hash_kernel_config(environment const & env, sha256 & h) {
+    static char const * features[] = {"inductive_extension", "quotient_extension", "hits_extension"};
+    std::string config;
+    config += env.prop_proof_irrel() ? '1' : '0';
+    config += env.impredicative() ? '1' : '0';
+    config += env.eta() ? '1' : '0';
+    for (char const * f : features)
+        config += env.norm_ext().supports(name(f)) ? '1' : '0';
+    h.update(config);
+}
+
+optional<ledger_key> declaration_key_fn::get_key(environment const & env, name const & n) {
+    {
+        lock_guard<mutex> lc(m_mutex);
+        if (auto k = m_keys.find(n))
+            return optional<ledger_key>(*k);
+    }
+    optional<declaration> d = env.find(n);
+    if (!d) {
+        // unknown constant, the declaration must be type checked
+        return optional<ledger_key>();
+    }
+    // constant was not keyed by the importer (e.g., it was created by a kernel extension)
+    optional<ledger_key> k = compute(env, *d);
+    if (k) {
+        lock_guard<mutex> lc(m_mutex);
+        m_keys.insert(n, *k);
+    }
+    return k;
+}
+
+optional<ledger_key> declaration_key_fn::compute(environment const & env, declaration const & d) {
+    sha256 h;
+    hash_kernel_config(env, h);
+    std::ostringstream out(std::ios_base::binary);
+    {
+        serializer s(out);
+        s << d;
+    }
+    h.update(out.str());
+    name_set deps;
+    auto collect = [&](expr const & e, unsigned) {
+        if (is_constant(e))
+            deps.insert(const_name(e));
+        return true;
+    };
+    for_each(d.get_type(), collect);
+    if (d.is_definition())
+        for_each(d.get_value(), collect);
+    // name_set is ordered, so the resulting key does not depend on the traversal order
+    bool ok = true;
+    deps.for_each([&](name const & n) {
+            if (!ok || n == d.get_name())
+                return;
+            if (auto k = get_key(env, n))
+                h.update(*k);
+            else
+                ok = false;
+        });
+    if (!ok)
+        return optional<ledger_key>();
+    return optional<ledger_key>(h.digest());
+}
+
+optional<ledger_key> declaration_key_fn::operator()(environment const & env, declaration const & d) {
+    optional<ledger_key> k = compute(env, d);
+    if (k) {
+        lock_guard<mutex> lc(m_mutex);
+        m_keys.insert(d.get_name(), *k);
+    }
+    return k;
+}
+
+static verification_ledger * g_verification_ledger = nullptr;
+
+void set_verification_ledger(verification_ledger * l) {
+    g_verification_ledger = l;
+}
+
+verification_ledger * get_verification_ledger() {
+    return g_verification_ledger;
+}
+}
@@ -0,0 +1,61 @@
+/*
+Copyright (c) 2015 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include "util/optional.h"
+#include "util/thread.h"
+#include "util/name_map.h"
+#include "kernel/declaration.h"
+
+namespace lean {
+class environment;
+/** \brief SHA-256 digest (32 bytes) identifying a declaration and its dependencies. */
+typedef std::string ledger_key;
+
+/** \brief Set of declaration keys that have been successfully type checked in some previous run.
+
+    The key of a declaration is the SHA-256 digest of the kernel configuration, its serialized form,
+    and the keys of all constants it references (see #declaration_key_fn). Thus, a key is only found in
+    the ledger if the declaration and its whole dependency closure were checked before by a kernel
+    with the same configuration.
+*/
+class verification_ledger {
+    mutable mutex                  m_mutex;
+    std::unordered_set<ledger_key> m_keys;
+    unsigned                       m_num_new;
+public:
+    verification_ledger():m_num_new(0) {}
+    bool contains(ledger_key const & k) const;
+    void add(ledger_key const & k);
+    /** \brief Return the number of keys added since the ledger was created/loaded. */
+    unsigned get_num_new() const;
+    /** \brief Store the ledger content into the given stream */
+    void save(std::ostream & out) const;
+    /** \brief Add the keys stored in the given stream to the ledger */
+    void load(std::istream & in);
+};
+
+/** \brief Compute the ledger key of declarations. Keys of referenced constants are memoized,
+    so a declaration must be keyed in an environment containing all constants it depends on.
+    The result is none if the declaration references a constant that is not in the environment.
+*/
+class declaration_key_fn {
+    mutex                 m_mutex;
+    name_map<ledger_key>  m_keys;
+    optional<ledger_key> get_key(environment const & env, name const & n);
+    optional<ledger_key> compute(environment const & env, declaration const & d);
+public:
+    optional<ledger_key> operator()(environment const & env, declaration const & d);
+};
+
+/** \brief Set the verification ledger used by \c import_modules.
+    When \c l is nullptr (default), every imported declaration is type checked (when trust level is 0). */
+void set_verification_ledger(verification_ledger * l);
+verification_ledger * get_verification_ledger();
+}
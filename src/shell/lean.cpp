@@ -19,6 +19,7 @@ Author: Leonardo de Moura
 #include "util/thread.h"
 #include "util/lean_path.h"
 #include "util/file_lock.h"
+#include "util/stats.h"
 #include "util/sexpr/options.h"
 #include "util/sexpr/option_declarations.h"
 #include "kernel/environment.h"
@@ -32,6 +33,7 @@ Author: Leonardo de Moura
 #include "library/type_context.h"
 #include "library/io_state_stream.h"
 #include "library/definition_cache.h"
+#include "library/verification_ledger.h"
 #include "library/declaration_index.h"
 #include "library/export.h"
 #include "library/error_handling.h"
@@ -54,6 +56,8 @@ using lean::regular;
 using lean::mk_environment;
 using lean::mk_hott_environment;
 using lean::definition_cache;
+using lean::verification_ledger;
+using lean::set_verification_ledger;
 using lean::pos_info;
 using lean::pos_info_provider;
 using lean::optional;
@@ -67,6 +71,9 @@ using lean::shared_file_lock;
 using lean::exclusive_file_lock;
 using lean::default_type_context;
 using lean::type_checker;
+using lean::stats_values;
+using lean::get_stats;
+using lean::display_group_stats;
 
 enum class input_kind { Unspecified, Lean, HLean, Trace };
 
@@ -74,6 +81,15 @@ static void on_ctrl_c(int ) {
     lean::request_interrupt();
 }
 
+/** \brief Display the statistics produced since \c start was taken. */
+static void display_file_stats(std::ostream & out, char const * fname, stats_values const & start) {
+    stats_values vs = get_stats();
+    for (unsigned i = 0; i < start.size(); i++)
+        vs[i] -= start[i];
+    out << "statistics for " << fname << "\n";
+    lean::display_stats(out, vs);
+}
+
 static void display_header(std::ostream & out) {
     out << "Lean (version " << LEAN_VERSION_MAJOR << "."
         << LEAN_VERSION_MINOR << "." << LEAN_VERSION_PATCH;
@@ -119,7 +135,12 @@ static void display_help(std::ostream & out) {
     std::cout << "  --flycheck        print structured error message for flycheck\n";
     std::cout << "  --cache=file -c   load/save cached definitions from/to the given file\n";
     std::cout << "  --index=file -i   store index for declared symbols in the given file\n";
+    std::cout << "  --ledger=file     skip type checking imported declarations recorded in the given\n";
+    std::cout << "                    verification ledger, and record newly checked ones (trust level 0)\n";
     std::cout << "  --profile         display elaboration/type checking time for each definition/theorem\n";
+    std::cout << "  --stats           display statistics (e.g., number of whnf calls) for each file and declaration\n";
+    std::cout << "  --whnf-machine    use an abstract machine for beta/let reduction in the kernel and\n";
+    std::cout << "                    elaborator (same as -D whnf_machine=true)\n";
 #if defined(LEAN_USE_BOOST)
     std::cout << "  --tstack=num -s   thread stack size in Kb\n";
 #endif
@@ -169,12 +190,15 @@ static struct option g_long_options[] = {
     {"discard",      no_argument,       0, 'r'},
     {"to_axiom",     no_argument,       0, 'X'},
     {"profile",      no_argument,       0, 'P'},
+    {"stats",        no_argument,       0, 'Y'},
+    {"whnf-machine", no_argument,       0, 'W'},
 #if defined(LEAN_MULTI_THREAD)
     {"server",       no_argument,       0, 'S'},
     {"threads",      required_argument, 0, 'j'},
 #endif
     {"quiet",        no_argument,       0, 'q'},
     {"cache",        required_argument, 0, 'c'},
+    {"ledger",       required_argument, 0, 'V'},
     {"deps",         no_argument,       0, 'd'},
     {"flycheck",     no_argument,       0, 'F'},
     {"index",        no_argument,       0, 'i'},
@@ -263,11 +287,14 @@ int main(int argc, char ** argv) {
     bool read_cache         = false;
     bool save_cache         = false;
     bool gen_index          = false;
+    bool use_ledger         = false;
+    bool stats              = false;
     keep_theorem_mode tmode = keep_theorem_mode::All;
     options opts;
     std::string output;
     std::string cache_name;
     std::string index_name;
+    std::string ledger_name;
     optional<unsigned> line;
     optional<unsigned> column;
     optional<std::string> export_txt;
@@ -323,6 +350,10 @@ int main(int argc, char ** argv) {
             read_cache = true;
             save_cache = true;
             break;
+        case 'V':
+            ledger_name = optarg;
+            use_ledger  = true;
+            break;
         case 'i':
             index_name = optarg;
             gen_index  = true;
@@ -360,6 +391,13 @@ int main(int argc, char ** argv) {
         case 'P':
             opts = opts.update("profile", true);
             break;
+        case 'Y':
+            opts  = opts.update("stats", true);
+            stats = true;
+            break;
+        case 'W':
+            opts = opts.update("whnf_machine", true);
+            break;
         case 'L':
             line = atoi(optarg);
             break;
@@ -443,7 +481,8 @@ int main(int argc, char ** argv) {
     if (has_hlean)
         lean::initialize_lean_path(true);
 
-    environment env = has_hlean ? mk_hott_environment(trust_lvl) : mk_environment(trust_lvl);
+    bool whnf_machine = lean::get_whnf_machine(opts);
+    environment env   = has_hlean ? mk_hott_environment(trust_lvl, whnf_machine) : mk_environment(trust_lvl, whnf_machine);
     io_state ios(opts, lean::mk_pretty_formatter_factory());
     definition_cache   cache;
     definition_cache * cache_ptr = nullptr;
@@ -468,6 +507,24 @@ int main(int argc, char ** argv) {
                 << ex.what() << ". cache is going to be ignored\n";
         }
     }
+    verification_ledger ledger;
+    if (use_ledger) {
+        try {
+            shared_file_lock ledger_lock(ledger_name);
+            std::ifstream in(ledger_name);
+            if (!in.bad() && !in.fail())
+                ledger.load(in);
+            set_verification_ledger(&ledger);
+        } catch (lean::throwable & ex) {
+            use_ledger = false;
+            lean::flycheck_error warn(ios);
+            if (optind < argc)
+                display_error_pos(ios.get_regular_stream(), ios.get_options(), argv[optind], 1, 0);
+            ios.get_regular_stream()
+                << "failed to load verification ledger '" << ledger_name << "', "
+                << ex.what() << ". ledger is going to be ignored\n";
+        }
+    }
     declaration_index index;
     declaration_index * index_ptr = nullptr;
     if (gen_index)
@@ -476,6 +533,9 @@ int main(int argc, char ** argv) {
     try {
         bool ok = true;
         for (int i = optind; i < argc; i++) {
+            stats_values file_stats;
+            if (stats)
+                file_stats = get_stats();
             try {
                 char const * ext = get_file_extension(argv[i]);
                 input_kind k     = default_k;
@@ -511,6 +571,12 @@ int main(int argc, char ** argv) {
                 auto out = diagnostic(env, ios, tc);
                 lean::display_error(out, &pp, ex);
             }
+            if (stats)
+                display_file_stats(std::cerr, argv[i], file_stats);
+        }
+        if (stats) {
+            std::cerr << "statistics for each declaration\n";
+            display_group_stats(std::cerr);
         }
         if (ok && server && (default_k == input_kind::Lean || default_k == input_kind::HLean)) {
             signal(SIGINT, on_ctrl_c);
@@ -524,6 +590,23 @@ int main(int argc, char ** argv) {
             std::ofstream out(cache_name, std::ofstream::binary);
             cache.save(out);
         }
+        if (use_ledger) {
+            set_verification_ledger(nullptr);
+            // only record verified declarations if everything was successfully processed
+            if (ok && ledger.get_num_new() > 0) {
+                exclusive_file_lock ledger_lock(ledger_name);
+                try {
+                    // merge the keys recorded by processes that finished after we loaded the ledger
+                    std::ifstream in(ledger_name);
+                    if (!in.bad() && !in.fail())
+                        ledger.load(in);
+                } catch (lean::throwable &) {
+                    // invalid ledger, it is overwritten
+                }
+                std::ofstream out(ledger_name);
+                ledger.save(out);
+            }
+        }
         if (gen_index) {
             exclusive_file_lock index_lock(index_name);
             std::shared_ptr<lean::file_output_channel> out(new lean::file_output_channel(index_name.c_str()));
@@ -540,12 +623,12 @@ int main(int argc, char ** argv) {
         if (export_txt) {
             exclusive_file_lock expor_lock(*export_txt);
             std::ofstream out(*export_txt);
-            export_module_as_lowtext(out, env);
+            export_module_as_lowtext(out, env, num_threads);
         }
         if (export_all_txt) {
             exclusive_file_lock export_lock(*export_all_txt);
             std::ofstream out(*export_all_txt);
-            export_all_as_lowtext(out, env);
+            export_all_as_lowtext(out, env, num_threads);
         }
         return ok ? 0 : 1;
     } catch (lean::throwable & ex) {
@@ -376,6 +376,39 @@ static void tst18() {
     lean_assert(!has_local(mk_app(f, a0, a0, a0, a0)));
 }
 
+static expr mk_big19(expr const & f, expr const & a, unsigned depth) {
+    if (depth == 0)
+        return a;
+    else
+        return mk_app(f, mk_big19(f, a, depth - 1), mk_big19(f, a, depth - 1));
+}
+
+static void tst19() {
+    expr f = Const("f");
+    expr a = Const("a");
+    expr b = Const("b");
+    expr t1 = mk_big19(f, a, 10);
+    expr t2 = mk_big19(f, a, 10);
+    expr t3 = mk_app(f, mk_big19(f, a, 9), mk_big19(f, b, 9));
+    lean_assert(get_hash2(t1) == get_hash2(t2));
+    lean_assert(get_hash2(t1) != get_hash2(t3));
+    for (unsigned i = 0; i < 3; i++) {
+        lean_assert(t1 == t2);
+        lean_assert(is_bi_equal(t1, t2));
+        lean_assert(t1 != t3);
+        lean_assert(t2 != t3);
+    }
+    expr Type = mk_Type();
+    expr x = Local("x", Type);
+    expr y = Local("y", Type);
+    expr l1 = Fun(x, mk_app(t1, x));
+    expr l2 = Fun(y, mk_app(t2, y));
+    lean_assert(get_hash2(l1) == get_hash2(l2));
+    lean_assert(l1 == l2);
+    lean_assert(!is_bi_equal(l1, l2));
+    lean_assert(get_hash2(mk_metavar("m", t1)) == get_hash2(mk_metavar("m", t2)));
+}
+
 int main() {
     save_stack_info();
     initialize_util_module();
@@ -402,6 +435,7 @@ int main() {
     tst16();
     tst17();
     tst18();
+    tst19();
     std::cout << "sizeof(expr):            " << sizeof(expr) << "\n";
     std::cout << "sizeof(expr_cell):       " << sizeof(expr_cell) << "\n";
     std::cout << "sizeof(expr_app):        " << sizeof(expr_app) << "\n";
@@ -9,6 +9,7 @@ Author: Leonardo de Moura
 #include "util/sexpr/init_module.h"
 #include "kernel/abstract.h"
 #include "kernel/instantiate.h"
+#include "kernel/whnf_machine.h"
 #include "kernel/init_module.h"
 #include "library/init_module.h"
 using namespace lean;
@@ -34,12 +35,34 @@ static void tst1() {
     lean_assert(head_beta_reduce(F3) == mk_app(f, mk_app(Fun(y, y), a), a));
 }
 
+static void tst2() {
+    expr f = Const("f");
+    expr N = Const("N");
+    expr x = Local("x", N);
+    expr y = Local("y", N);
+    expr g = Local("g", N >> N);
+    expr a = Const("a");
+    expr b = Const("b");
+    lean_assert(is_eqp(whnf_beta_zeta(mk_app(f, a)), mk_app(f, a)));
+    expr F1 = mk_app(Fun({x, y}, mk_app(f, y, x)), a, b);
+    lean_assert_eq(whnf_beta_zeta(F1), mk_app(f, b, a));
+    expr F2 = mk_app(Fun(g, mk_app(g, a)), Fun(x, mk_app(Fun(y, mk_app(f, x, y)), b)));
+    lean_assert_eq(whnf_beta_zeta(F2), mk_app(f, a, b));
+    expr F3 = mk_let("z", N, a, mk_app(Fun(x, mk_app(f, x, Var(1))), b));
+    lean_assert_eq(whnf_beta_zeta(F3), mk_app(f, b, a));
+    expr F4 = mk_app(Fun(x, Fun(y, mk_app(f, x, y))), a);
+    lean_assert_eq(whnf_beta_zeta(F4), Fun(y, mk_app(f, a, y)));
+    expr F5 = mk_app(Fun(x, mk_app(Fun(y, y), x)), mk_app(f, Var(0)));
+    lean_assert_eq(whnf_beta_zeta(F5), mk_app(f, Var(0)));
+}
+
 int main() {
     save_stack_info();
     initialize_util_module();
     initialize_sexpr_module();
     initialize_kernel_module();
     tst1();
+    tst2();
     finalize_kernel_module();
     finalize_sexpr_module();
     finalize_util_module();
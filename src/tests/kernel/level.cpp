@@ -65,6 +65,27 @@ static void tst2() {
     lean_assert(!is_equivalent(zero, p2));
 }
 
+static void tst3() {
+    level p1 = mk_param_univ("p1");
+    level p2 = mk_param_univ("p2");
+    level l1 = mk_max(mk_succ(p1), mk_max(p2, p1));
+    level l2 = mk_max(p2, mk_succ(p1));
+    /* repeated queries are answered by the normalize and is_geq caches */
+    for (unsigned i = 0; i < 3; i++) {
+        lean_assert(normalize(l1) == normalize(l2));
+        lean_assert(is_equivalent(l1, l2));
+        lean_assert(is_geq(l1, p1));
+        lean_assert(is_geq(l1, p2));
+        lean_assert(!is_geq(p1, l1));
+        lean_assert(!is_geq(p2, p1));
+        lean_assert(is_geq(mk_succ(l1), l2));
+    }
+    bool old = enable_level_caching(true);
+    lean_assert(is_geq(l1, mk_succ(p1)));
+    lean_assert(!is_geq(l1, mk_succ(p2)));
+    enable_level_caching(old);
+}
+
 int main() {
     save_stack_info();
     initialize_util_module();
@@ -73,6 +94,7 @@ int main() {
     initialize_library_module();
     tst1();
     tst2();
+    tst3();
     finalize_library_module();
     finalize_kernel_module();
     finalize_sexpr_module();
@@ -0,0 +1,84 @@
+/*
+Copyright (c) 2015 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <sstream>
+#include "util/test.h"
+#include "util/init_module.h"
+#include "util/sexpr/init_module.h"
+#include "kernel/environment.h"
+#include "kernel/type_checker.h"
+#include "kernel/init_module.h"
+#include "library/verification_ledger.h"
+#include "library/init_module.h"
+using namespace lean;
+
+static environment add_axiom(environment const & env, name const & n, expr const & t) {
+    return env.add(check(env, mk_axiom(n, level_param_names(), t)));
+}
+
+static void tst1() {
+    environment env;
+    expr Prop = mk_Prop();
+    env = add_axiom(env, "A", Prop);
+    env = add_axiom(env, "a", mk_constant("A"));
+    declaration d = mk_definition(env, "b", level_param_names(), mk_constant("A"), mk_constant("a"));
+    ledger_key k1 = *declaration_key_fn()(env, d);
+    lean_assert_eq(k1.size(), 32u);
+    lean_assert(k1 == *declaration_key_fn()(env, d));
+    // changing a dependency changes the key
+    environment env2;
+    env2 = add_axiom(env2, "A", mk_Type());
+    env2 = add_axiom(env2, "a", mk_constant("A"));
+    ledger_key k2 = *declaration_key_fn()(env2, d);
+    lean_assert(k1 != k2);
+    // changing the declaration itself changes the key
+    declaration d2 = mk_definition("b", level_param_names(), mk_constant("A"), mk_constant("a"), 5);
+    lean_assert(k1 != *declaration_key_fn()(env, d2));
+    // the kernel configuration is part of the key
+    environment env3(0, false);
+    env3 = add_axiom(env3, "A", Prop);
+    env3 = add_axiom(env3, "a", mk_constant("A"));
+    lean_assert(k1 != *declaration_key_fn()(env3, d));
+    // declarations referencing unknown constants have no key
+    lean_assert(!declaration_key_fn()(environment(), d));
+
+    verification_ledger l1;
+    l1.add(k1);
+    lean_assert(l1.contains(k1));
+    lean_assert(!l1.contains(k2));
+    lean_assert_eq(l1.get_num_new(), 1u);
+    std::ostringstream out;
+    l1.save(out);
+    verification_ledger l2;
+    std::istringstream in(out.str());
+    l2.load(in);
+    lean_assert(l2.contains(k1));
+    lean_assert(!l2.contains(k2));
+    lean_assert_eq(l2.get_num_new(), 0u);
+    // certification skips type checking, but still rejects duplicate names
+    declaration bad = mk_definition("c", level_param_names(), Prop, mk_constant("a"));
+    env = env.add(check_previously_verified(env, bad));
+    lean_assert(env.find("c"));
+    try {
+        check_previously_verified(env, bad);
+        lean_unreachable();
+    } catch (exception &) {
+    }
+}
+
+int main() {
+    save_stack_info();
+    initialize_util_module();
+    initialize_sexpr_module();
+    initialize_kernel_module();
+    initialize_library_module();
+    tst1();
+    finalize_library_module();
+    finalize_kernel_module();
+    finalize_sexpr_module();
+    finalize_util_module();
+    return has_violations() ? 1 : 0;
+}
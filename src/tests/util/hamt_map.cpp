@@ -0,0 +1,140 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <iostream>
+#include <vector>
+#include "util/test.h"
+#include "util/hamt_map.h"
+#include "util/rb_map.h"
+#include "util/name.h"
+#include "util/init_module.h"
+using namespace lean;
+
+struct unsigned_hash { unsigned operator()(unsigned v) const { return v; } };
+/* Bad hash function for testing collisions */
+struct collision_hash { unsigned operator()(unsigned v) const { return v % 3; } };
+typedef hamt_map<unsigned, name, unsigned_hash, unsigned_cmp> u2name;
+typedef hamt_map<unsigned, unsigned, collision_hash, unsigned_cmp> u2u_collision;
+typedef hamt_map<name, unsigned, name_hash, name_quick_cmp> name2u;
+
+static void tst0() {
+    u2name m1;
+    m1[10] = name("t1");
+    m1[20] = name("t2");
+    u2name m2(m1);
+    m2[10] = name("t3");
+    lean_assert(m1[10] == name("t1"));
+    lean_assert(m1[20] == name("t2"));
+    lean_assert(m2[10] == name("t3"));
+    lean_assert(m2[20] == name("t2"));
+    lean_assert(m2.size() == 2);
+    lean_assert(m2[100] == name());
+    lean_assert(m2.size() == 3);
+    lean_assert(m2[100] == name());
+    lean_assert(m2.size() == 3);
+    lean_assert(m1.size() == 2);
+}
+
+static void tst1() {
+    u2name m1, m2;
+    m1[10] = name("t1");
+    lean_assert(m1.size() == 1);
+    lean_assert(m2.size() == 0);
+    swap(m1, m2);
+    lean_assert(m2.size() == 1);
+    lean_assert(m1.size() == 0);
+}
+
+static void tst2() {
+    /* keys with a common hash code prefix, and snapshots */
+    u2name m;
+    std::vector<u2name> snapshots;
+    unsigned n = 5000;
+    for (unsigned i = 0; i < n; i++) {
+        m.insert(i * 7919u, name(name("x"), i));
+        if (i % 1000 == 0)
+            snapshots.push_back(m);
+    }
+    lean_assert(m.size() == n);
+    for (unsigned i = 0; i < n; i++) {
+        lean_assert(m.contains(i * 7919u));
+        lean_assert(*m.find(i * 7919u) == name(name("x"), i));
+    }
+    lean_assert(!m.contains(1));
+    for (unsigned j = 0; j < snapshots.size(); j++) {
+        lean_assert(snapshots[j].size() == j * 1000 + 1);
+        lean_assert(snapshots[j].contains(j * 1000 * 7919u));
+        lean_assert(!snapshots[j].contains((j * 1000 + 1) * 7919u));
+    }
+    u2name m2 = m;
+    for (unsigned i = 0; i < n; i += 2)
+        m2.erase(i * 7919u);
+    lean_assert(m2.size() == n / 2);
+    lean_assert(m.size() == n);
+    for (unsigned i = 0; i < n; i++) {
+        lean_assert(m.contains(i * 7919u));
+        lean_assert(m2.contains(i * 7919u) == (i % 2 == 1));
+    }
+    m2.erase(1);
+    lean_assert(m2.size() == n / 2);
+    for (unsigned i = 1; i < n; i += 2)
+        m2.erase(i * 7919u);
+    lean_assert(m2.empty());
+}
+
+static void tst3() {
+    /* all keys collide */
+    u2u_collision m;
+    for (unsigned i = 0; i < 100; i++)
+        m.insert(i, i + 1);
+    lean_assert(m.size() == 100);
+    for (unsigned i = 0; i < 100; i++)
+        lean_assert(*m.find(i) == i + 1);
+    unsigned prev = 0;
+    bool first    = true;
+    m.for_each([&](unsigned k, unsigned) {
+            if (!first) {
+                /* traversal order is (hash code, cmp) */
+                lean_assert(k % 3 > prev % 3 || (k % 3 == prev % 3 && k > prev));
+            }
+            first = false;
+            prev  = k;
+        });
+    for (unsigned i = 0; i < 100; i += 3)
+        m.erase(i);
+    lean_assert(m.size() == 66);
+    lean_assert(!m.contains(3));
+    lean_assert(m.contains(4));
+}
+
+static void tst4() {
+    /* traversal order is the same one of rb_map<name, T, name_quick_cmp> */
+    name2u m1;
+    rb_map<name, unsigned, name_quick_cmp> m2;
+    for (unsigned i = 0; i < 1000; i++) {
+        name n(name("foo"), (i * 31) % 1000);
+        m1.insert(n, i);
+        m2.insert(n, i);
+    }
+    std::vector<name> ns1, ns2;
+    m1.for_each([&](name const & n, unsigned) { ns1.push_back(n); });
+    m2.for_each([&](name const & n, unsigned) { ns2.push_back(n); });
+    lean_assert(ns1 == ns2);
+    lean_assert(m1.find_if([](name const &, unsigned v) { return v == 10; }));
+    lean_assert(!m1.find_if([](name const &, unsigned v) { return v == 1000; }));
+}
+
+int main() {
+    save_stack_info();
+    initialize_util_module();
+    tst0();
+    tst1();
+    tst2();
+    tst3();
+    tst4();
+    finalize_util_module();
+    return has_violations() ? 1 : 0;
+}
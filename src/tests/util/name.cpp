@@ -137,6 +137,26 @@ static void tst12() {
     lean_assert(mk_unique(s, name("foo")) == name(name("foo"), 2));
 }
 
+static void tst13() {
+    name::ptr_eq eq;
+    name n1 = name{"foo", "bla"};
+    name n2 = string_to_name("foo.bla");
+    lean_assert(eq(n1, n2));
+    lean_assert(eq(name(n1, 1), name(n2, 1)));
+    lean_assert(eq(n1.get_prefix(), name("foo")));
+    lean_assert(eq(name("foo") + name({"bla", "boo"}), name(n2, "boo")));
+    lean_assert(!eq(name(n1, 1), name(n1, 2)));
+    {
+        // the entry for foo.bla.tmp is removed from the intern table when it is deleted
+        name tmp(n1, "tmp");
+        lean_assert(eq(tmp, name({"foo", "bla", "tmp"})));
+    }
+    name tmp(n1, "tmp");
+    lean_assert(tmp == name({"foo", "bla", "tmp"}));
+    lean_assert(cmp(name(n1, "aaa"), name(n2, "bbb")) < 0);
+    lean_assert(cmp(name(n1, "bbb"), name(n2, "aaa")) > 0);
+}
+
 int main() {
     save_stack_info();
     initialize_util_module();
@@ -150,6 +170,7 @@ int main() {
     tst8();
     tst11();
     tst12();
+    tst13();
     finalize_util_module();
     return has_violations() ? 1 : 0;
 }
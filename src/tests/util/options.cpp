@@ -154,6 +154,39 @@ static void tst6() {
     check_serializer(opt);
 }
 
+static void tst7() {
+    /* registered options can be read using their slots */
+    name fakeopt("fakeopt");
+    options opt = update(options(), fakeopt, true);
+    opt = update(opt, name{"test", "unregistered"}, 3);
+    lean_assert(opt.contains(fakeopt));
+    lean_assert(opt.get_bool(fakeopt, false));
+    lean_assert(opt.get_unsigned(name{"test", "unregistered"}, 0) == 3);
+    optional<option_slot> fakeopt_slot = get_option_slot(fakeopt);
+    lean_assert(fakeopt_slot);
+    lean_assert(opt.get_bool(*fakeopt_slot, false));
+    lean_assert(!options().get_bool(*fakeopt_slot, false));
+    /* options declared after the creation of opt are also found */
+    name fakeopt3("fakeopt3");
+    options opt_old = update(opt, fakeopt3, 2);
+    option_slot fakeopt3_slot = register_unsigned_option(fakeopt3, 5, "fake option 3");
+    lean_assert(get_option_slot_name(fakeopt3_slot) == fakeopt3);
+    lean_assert(opt_old.get_unsigned(fakeopt3, 5) == 2);
+    lean_assert(opt_old.get_unsigned(fakeopt3_slot, 5) == 2);
+    options opt2 = update(opt, fakeopt3, 7);
+    lean_assert(!opt.contains(fakeopt3));
+    lean_assert(opt2.get_unsigned(fakeopt3, 5) == 7);
+    lean_assert(opt2.get_bool(fakeopt, false));
+    opt2 = update(opt2, fakeopt, false);
+    lean_assert(!opt2.get_bool(fakeopt, true));
+    lean_assert(!opt2.get_bool(*fakeopt_slot, true));
+    lean_assert(opt2.get_unsigned(fakeopt3_slot, 5) == 7);
+    lean_assert(opt.get_bool(fakeopt, false));
+    options opt3 = join(opt2, options(fakeopt, true));
+    lean_assert(opt3.get_bool(fakeopt, false));
+    lean_assert(opt3.get_unsigned(fakeopt3, 5) == 7);
+}
+
 int main() {
     save_stack_info();
     initialize_util_module();
@@ -167,6 +200,7 @@ int main() {
     tst4();
     tst5();
     tst6();
+    tst7();
 
     finalize_sexpr_module();
     finalize_util_module();
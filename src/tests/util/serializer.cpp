@@ -11,6 +11,7 @@ Author: Leonardo de Moura
 #include <vector>
 #include <functional>
 #include <cmath>
+#include <limits>
 #include "util/test.h"
 #include "util/object_serializer.h"
 #include "util/debug.h"
@@ -171,6 +172,35 @@ static void tst4() {
     lean_assert_eq(d5, o5);
 }
 
+static void tst5() {
+    std::ostringstream out;
+    serializer s(out);
+    s.write_unsigned(0); s.write_unsigned(127); s.write_unsigned(128); s.write_unsigned(300);
+    s.write_unsigned(std::numeric_limits<unsigned>::max());
+    s.write_uint64(std::numeric_limits<uint64>::max()); s.write_uint64(1ull << 40);
+    s.write_string("hello"); s.write_string("world"); s.write_string("hello"); s.write_string("");
+    std::string str = out.str();
+    // varints and the string table keep the encoding compact
+    lean_assert_eq(str.size(), 1 + 1 + 2 + 2 + 5 + 10 + 6 + 7 + 7 + 1 + 2);
+    deserializer d(str.data(), str.data() + str.size());
+    lean_assert_eq(d.read_unsigned(), 0u);
+    lean_assert_eq(d.read_unsigned(), 127u);
+    lean_assert_eq(d.read_unsigned(), 128u);
+    lean_assert_eq(d.read_unsigned(), 300u);
+    lean_assert_eq(d.read_unsigned(), std::numeric_limits<unsigned>::max());
+    lean_assert(d.read_uint64() == std::numeric_limits<uint64>::max());
+    lean_assert(d.read_uint64() == (1ull << 40));
+    lean_assert(d.read_string() == "hello");
+    lean_assert(d.read_string() == "world");
+    lean_assert(d.read_string() == "hello");
+    lean_assert(d.read_string() == "");
+    try {
+        d.read_unsigned();
+        lean_unreachable();
+    } catch (corrupted_stream_exception &) {
+    }
+}
+
 int main() {
     save_stack_info();
     initialize_util_module();
@@ -179,6 +209,7 @@ int main() {
     tst2();
     tst3();
     tst4();
+    tst5();
     finalize_util_module();
     return has_violations() ? 1 : 0;
 }
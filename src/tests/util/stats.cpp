@@ -0,0 +1,92 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <sstream>
+#include <string>
+#include <vector>
+#include "util/test.h"
+#include "util/thread.h"
+#include "util/stats.h"
+#include "util/init_module.h"
+using namespace lean;
+
+static stats_id g_c1 = 0;
+static stats_id g_c2 = 0;
+static stats_id g_h  = 0;
+
+static void tst1() {
+    stats_values s0 = get_stats();
+    stats_inc(g_c1);
+    stats_inc(g_c1, 10);
+    stats_record(g_h, 0);
+    stats_record(g_h, 5);
+    stats_record(g_h, 7);
+    stats_values s1 = get_stats();
+    lean_assert(s1[g_c1] == s0[g_c1] + 11);
+    lean_assert(s1[g_c2] == s0[g_c2]);
+    lean_assert(s1[g_h] == s0[g_h] + 1);         // bucket for 0
+    lean_assert(s1[g_h + 3] == s0[g_h + 3] + 2); // bucket for [4, 8)
+    lean_assert(get_thread_stats()[g_c1] == s1[g_c1]);
+    std::ostringstream out;
+    display_stats(out, s1);
+    std::cout << out.str();
+    lean_assert(out.str().find("test.c1 11") != std::string::npos);
+    lean_assert(out.str().find("test.c2") == std::string::npos);
+}
+
+static void tst2() {
+    {
+        scope_stats_group scope("foo");
+        stats_inc(g_c2, 3);
+    }
+    {
+        scope_stats_group scope("bar", false);
+        stats_inc(g_c2, 3);
+    }
+    {
+        scope_stats_group scope("foo");
+        stats_inc(g_c2, 2);
+    }
+    std::ostringstream out;
+    display_group_stats(out);
+    std::cout << out.str();
+    lean_assert(out.str() == "foo\n  test.c2 5\n");
+    clear_group_stats();
+}
+
+#if defined(LEAN_MULTI_THREAD)
+static void tst3() {
+    stats_values s0 = get_stats();
+    unsigned num_threads = 4;
+    unsigned n = 10000;
+    std::vector<thread> ts;
+    for (unsigned i = 0; i < num_threads; i++) {
+        ts.push_back(thread([&]() {
+                    for (unsigned j = 0; j < n; j++)
+                        stats_inc(g_c2);
+                    run_thread_finalizers();
+                }));
+    }
+    for (thread & t : ts)
+        t.join();
+    lean_assert(get_stats()[g_c2] == s0[g_c2] + num_threads * n);
+}
+#else
+static void tst3() {}
+#endif
+
+int main() {
+    save_stack_info();
+    initialize_util_module();
+    g_c1 = register_stats_counter(name{"test", "c1"}, "test counter 1");
+    g_c2 = register_stats_counter(name{"test", "c2"}, "test counter 2");
+    g_h  = register_stats_histogram(name{"test", "h"}, "test histogram");
+    tst1();
+    tst2();
+    tst3();
+    finalize_util_module();
+    return has_violations() ? 1 : 0;
+}
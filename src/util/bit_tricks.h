@@ -9,4 +9,14 @@ Author: Leonardo de Moura
 namespace lean {
 inline bool is_power_of_two(unsigned v) { return !(v & (v - 1)) && v; }
 unsigned log2(unsigned v);
+/** \brief Return the number of bits set in \c v. */
+inline unsigned popcount(unsigned v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(v);
+#else
+    unsigned r = 0;
+    for (; v; v &= v - 1) r++;
+    return r;
+#endif
+}
 }
@@ -0,0 +1,327 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "util/rc.h"
+#include "util/debug.h"
+#include "util/pair.h"
+#include "util/optional.h"
+#include "util/bit_tricks.h"
+
+namespace lean {
+/**
+   \brief Persistent hash array mapped trie.
+
+   It uses a O(1) copy operation, and different maps can share nodes (the sharing is thread-safe).
+   Lookups and updates are O(1) expected: a path has at most 8 nodes since each level
+   consumes 5 bits of the 32-bit hash code.
+
+   Update operations only copy the nodes that are shared. So, when the map is not shared
+   (e.g., it is a local object being populated in a loop), a batch of insertions is performed
+   in place (transient mode) without copying nodes.
+
+   The hash code is consumed from the most significant bits to the least significant ones, and
+   entries with the same hash code are kept sorted using \c CMP. Thus, the traversal order is
+   the lexicographic order (hash code, CMP). In particular, if \c CMP compares hash codes first
+   (e.g., \c name_quick_cmp), then the traversal order is the same one of <tt>rb_map<K, T, CMP></tt>.
+
+   \c HASH is a functional object <tt>unsigned operator()(K const & k) const</tt>, and
+   \c CMP is a functional object <tt>int operator()(K const & k1, K const & k2) const</tt>
+   (see \c rb_tree).
+*/
+template<typename K, typename T, typename HASH, typename CMP>
+class hamt_map : public CMP, public HASH {
+public:
+    typedef pair<K, T> entry;
+private:
+    static constexpr unsigned num_bits  = 5;
+    static constexpr unsigned max_depth = 7;
+
+    struct cell;
+    struct node {
+        cell * m_ptr;
+        node():m_ptr(nullptr) {}
+        node(cell * ptr):m_ptr(ptr) { if (m_ptr) ptr->inc_ref(); }
+        node(node const & s):m_ptr(s.m_ptr) { if (m_ptr) m_ptr->inc_ref(); }
+        node(node && s):m_ptr(s.m_ptr) { s.m_ptr = nullptr; }
+        ~node() { if (m_ptr) m_ptr->dec_ref(); }
+        node & operator=(node const & n) { LEAN_COPY_REF(n); }
+        node & operator=(node&& n) { LEAN_MOVE_REF(n); }
+        operator bool() const { return m_ptr != nullptr; }
+        bool is_shared() const { return m_ptr && m_ptr->get_rc() > 1; }
+        cell * operator->() const { lean_assert(m_ptr); return m_ptr; }
+        friend bool is_eqp(node const & n1, node const & n2) { return n1.m_ptr == n2.m_ptr; }
+        friend void swap(node & n1, node & n2) { std::swap(n1.m_ptr, n2.m_ptr); }
+        node steal() { node r; swap(r, *this); return r; }
+    };
+
+    /* A cell is either a leaf or an inner node.
+       - A leaf contains the (nonempty) sequence of entries with hash code \c m_hash.
+       - An inner node contains a child for each bit set in \c m_bitmap. */
+    struct cell {
+        bool               m_leaf;
+        unsigned           m_hash;
+        unsigned           m_bitmap;
+        std::vector<entry> m_entries;
+        std::vector<node>  m_children;
+        MK_LEAN_RC();
+        void dealloc() { delete this; }
+        cell(unsigned h, entry const & e):m_leaf(true), m_hash(h), m_bitmap(0), m_entries(1, e), m_rc(0) {}
+        cell():m_leaf(false), m_hash(0), m_bitmap(0), m_rc(0) {}
+        cell(cell const & s):m_leaf(s.m_leaf), m_hash(s.m_hash), m_bitmap(s.m_bitmap),
+                             m_entries(s.m_entries), m_children(s.m_children), m_rc(0) {}
+    };
+
+    node     m_root;
+    unsigned m_size;
+
+    static unsigned chunk(unsigned h, unsigned depth) {
+        lean_assert(depth < max_depth);
+        unsigned used = num_bits * depth;
+        if (used + num_bits <= 32)
+            return (h >> (32 - used - num_bits)) & ((1u << num_bits) - 1);
+        else
+            return h & ((1u << (32 - used)) - 1);
+    }
+
+    static unsigned child_pos(unsigned bitmap, unsigned idx) {
+        return popcount(bitmap & ((1u << idx) - 1));
+    }
+
+    static node ensure_unshared(node && n) {
+        if (n.is_shared()) {
+            return node(new cell(*n.m_ptr));
+        } else {
+            return n;
+        }
+    }
+
+    int cmp(K const & k1, K const & k2) const { return CMP::operator()(k1, k2); }
+    unsigned hash(K const & k) const { return HASH::operator()(k); }
+
+    /* Return the position of the first entry in the leaf \c n that is not smaller than \c k. */
+    unsigned lower_bound(cell const * n, K const & k) const {
+        lean_assert(n->m_leaf);
+        auto it = std::lower_bound(n->m_entries.begin(), n->m_entries.end(), k,
+                                   [&](entry const & e, K const & k) { return cmp(e.first, k) < 0; });
+        return it - n->m_entries.begin();
+    }
+
+    node insert(node && n, unsigned h, entry const & e, unsigned depth, bool & added) {
+        if (!n) {
+            added = true;
+            return node(new cell(h, e));
+        }
+        if (n->m_leaf && n->m_hash == h) {
+            node r = ensure_unshared(n.steal());
+            unsigned i = lower_bound(r.m_ptr, e.first);
+            if (i < r->m_entries.size() && cmp(r->m_entries[i].first, e.first) == 0) {
+                r->m_entries[i] = e;
+            } else {
+                added = true;
+                r->m_entries.insert(r->m_entries.begin() + i, e);
+            }
+            return r;
+        }
+        node r;
+        if (n->m_leaf) {
+            /* n is a leaf with a different hash code, we replace it with an inner node */
+            lean_assert(depth < max_depth);
+            r = node(new cell());
+            r->m_bitmap = 1u << chunk(n->m_hash, depth);
+            r->m_children.push_back(n.steal());
+        } else {
+            r = ensure_unshared(n.steal());
+        }
+        unsigned idx = chunk(h, depth);
+        unsigned pos = child_pos(r->m_bitmap, idx);
+        if (r->m_bitmap & (1u << idx)) {
+            r->m_children[pos] = insert(r->m_children[pos].steal(), h, e, depth + 1, added);
+        } else {
+            added = true;
+            r->m_bitmap |= 1u << idx;
+            r->m_children.insert(r->m_children.begin() + pos, node(new cell(h, e)));
+        }
+        return r;
+    }
+
+    /* \pre The map contains an entry for \c k */
+    node erase(node && n, unsigned h, K const & k, unsigned depth) {
+        lean_assert(n);
+        if (n->m_leaf) {
+            lean_assert(n->m_hash == h);
+            if (n->m_entries.size() == 1)
+                return node();
+            node r = ensure_unshared(n.steal());
+            r->m_entries.erase(r->m_entries.begin() + lower_bound(r.m_ptr, k));
+            return r;
+        }
+        node r = ensure_unshared(n.steal());
+        unsigned idx = chunk(h, depth);
+        unsigned pos = child_pos(r->m_bitmap, idx);
+        lean_assert(r->m_bitmap & (1u << idx));
+        node new_child = erase(r->m_children[pos].steal(), h, k, depth + 1);
+        if (new_child) {
+            r->m_children[pos] = new_child;
+        } else {
+            r->m_bitmap &= ~(1u << idx);
+            r->m_children.erase(r->m_children.begin() + pos);
+        }
+        if (r->m_children.empty())
+            return node();
+        if (r->m_children.size() == 1 && r->m_children[0]->m_leaf) {
+            /* a leaf can be stored at any depth, so we collapse inner nodes containing only one leaf */
+            return node(r->m_children[0]);
+        }
+        return r;
+    }
+
+    template<typename F>
+    static bool for_each(cell const * n, F && f) {
+        if (n->m_leaf) {
+            for (entry const & e : n->m_entries) {
+                if (f(e))
+                    return true;
+            }
+        } else {
+            for (node const & c : n->m_children) {
+                if (for_each(c.m_ptr, f))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    /* Apply \c f to the entries in traversal order until it returns true. */
+    template<typename F>
+    bool for_each_core(F && f) const {
+        return m_root ? for_each(m_root.m_ptr, f) : false;
+    }
+
+public:
+    hamt_map(CMP const & cmp = CMP(), HASH const & h = HASH()):CMP(cmp), HASH(h), m_size(0) {}
+    hamt_map(hamt_map const & m):CMP(m), HASH(m), m_root(m.m_root), m_size(m.m_size) {}
+    hamt_map(hamt_map && m):CMP(m), HASH(m), m_root(m.m_root.steal()), m_size(m.m_size) {}
+    hamt_map & operator=(hamt_map const & m) { m_root = m.m_root; m_size = m.m_size; return *this; }
+    hamt_map & operator=(hamt_map && m) { m_root = m.m_root.steal(); m_size = m.m_size; return *this; }
+
+    friend void swap(hamt_map & a, hamt_map & b) { swap(a.m_root, b.m_root); std::swap(a.m_size, b.m_size); }
+    bool empty() const { return m_size == 0; }
+    void clear() { m_root = node(); m_size = 0; }
+    bool is_eqp(hamt_map const & m) const { return m_root.m_ptr == m.m_root.m_ptr; }
+    unsigned size() const { return m_size; }
+    unsigned get_rc() const { return m_root ? m_root->get_rc() : 0; }
+
+    void insert(K const & k, T const & v) {
+        bool added = false;
+        m_root = insert(m_root.steal(), hash(k), mk_pair(k, v), 0, added);
+        if (added)
+            m_size++;
+    }
+
+    void erase(K const & k) {
+        if (!contains(k))
+            return;
+        m_root = erase(m_root.steal(), hash(k), k, 0);
+        m_size--;
+    }
+
+    T const * find(K const & k) const {
+        unsigned h     = hash(k);
+        cell const * n = m_root.m_ptr;
+        unsigned depth = 0;
+        while (n) {
+            if (n->m_leaf) {
+                if (n->m_hash != h)
+                    return nullptr;
+                for (entry const & e : n->m_entries) {
+                    if (cmp(e.first, k) == 0)
+                        return &e.second;
+                }
+                return nullptr;
+            }
+            unsigned idx = chunk(h, depth);
+            if ((n->m_bitmap & (1u << idx)) == 0)
+                return nullptr;
+            n = n->m_children[child_pos(n->m_bitmap, idx)].m_ptr;
+            depth++;
+        }
+        return nullptr;
+    }
+
+    bool contains(K const & k) const { return find(k) != nullptr; }
+
+    class ref {
+        hamt_map & m_map;
+        K const &  m_key;
+    public:
+        ref(hamt_map & m, K const & k):m_map(m), m_key(k) {}
+        ref & operator=(T const & v) { m_map.insert(m_key, v); return *this; }
+        operator T const &() const {
+            T const * e = m_map.find(m_key);
+            if (e) {
+                return *e;
+            } else {
+                m_map.insert(m_key, T());
+                return *(m_map.find(m_key));
+            }
+        }
+    };
+
+    /**
+       \brief Returns a reference to the value that is mapped to a key equivalent to key,
+       performing an insertion if such key does not already exist.
+    */
+    ref operator[](K const & k) { return ref(*this, k); }
+
+    template<typename F>
+    void for_each(F && f) const {
+        for_each_core([&](entry const & e) { f(e.first, e.second); return false; });
+    }
+
+    template<typename F>
+    optional<T> find_if(F && f) const {
+        optional<T> r;
+        for_each_core([&](entry const & e) {
+                if (f(e.first, e.second)) {
+                    r = e.second;
+                    return true;
+                }
+                return false;
+            });
+        return r;
+    }
+
+    /** \brief (For debugging) Display the content of this map. */
+    friend std::ostream & operator<<(std::ostream & out, hamt_map const & m) {
+        out << "{";
+        m.for_each([&out](K const & k, T const & v) {
+                out << k << " |-> " << v << "; ";
+            });
+        out << "}";
+        return out;
+    }
+};
+template<typename K, typename T, typename HASH, typename CMP>
+hamt_map<K, T, HASH, CMP> insert(hamt_map<K, T, HASH, CMP> const & m, K const & k, T const & v) {
+    auto r = m;
+    r.insert(k, v);
+    return r;
+}
+template<typename K, typename T, typename HASH, typename CMP>
+hamt_map<K, T, HASH, CMP> erase(hamt_map<K, T, HASH, CMP> const & m, K const & k) {
+    auto r = m;
+    r.erase(k);
+    return r;
+}
+template<typename K, typename T, typename HASH, typename CMP, typename F>
+void for_each(hamt_map<K, T, HASH, CMP> const & m, F && f) {
+    return m.for_each(f);
+}
+}
@@ -11,6 +11,7 @@ Author: Leonardo de Moura
 #include "util/lean_path.h"
 #include "util/thread.h"
 #include "util/memory_pool.h"
+#include "util/stats.h"
 
 namespace lean {
 void initialize_util_module() {
@@ -19,10 +20,12 @@ void initialize_util_module() {
     initialize_thread();
     initialize_ascii();
     initialize_name();
+    initialize_stats();
     initialize_lean_path();
 }
 void finalize_util_module() {
     finalize_lean_path();
+    finalize_stats();
     finalize_name();
     finalize_ascii();
     finalize_thread();
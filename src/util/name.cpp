@@ -9,6 +9,7 @@ Author: Leonardo de Moura
 #include <algorithm>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include "util/thread.h"
 #include "util/name.h"
 #include "util/sstream.h"
@@ -20,6 +21,10 @@ Author: Leonardo de Moura
 #include "util/utf8.h"
 #include "util/object_serializer.h"
 
+#ifndef LEAN_NAME_TABLE_NUM_SHARDS
+#define LEAN_NAME_TABLE_NUM_SHARDS 64
+#endif
+
 namespace lean {
 constexpr char const * anonymous_str = "[anonymous]";
 
@@ -53,10 +58,71 @@ void copy_limbs(name::imp * p, buffer<name::imp *> & limbs) {
 
 DEF_THREAD_MEMORY_POOL(get_numeric_name_allocator, sizeof(name::imp));
 
+bool name::imp::try_inc_ref() {
+    unsigned rc = get_rc();
+    while (rc != 0) {
+        if (m_rc.compare_exchange_weak(rc, rc + 1))
+            return true;
+    }
+    return false;
+}
+
+/** \brief Global intern table for hierarchical names.
+
+    The table is partitioned in shards (selected using the hash code) to reduce contention.
+    An entry is removed from the table when its reference counter reaches zero.
+    Before the entry is removed, lookups ignore it (see \c name::imp::try_inc_ref). */
+struct name_table {
+    struct shard {
+        mutex                                         m_mutex;
+        std::unordered_multimap<unsigned, name::imp*> m_entries;
+    };
+    shard m_shards[LEAN_NAME_TABLE_NUM_SHARDS];
+    shard & get_shard(unsigned h) { return m_shards[h % LEAN_NAME_TABLE_NUM_SHARDS]; }
+};
+
+/* Remark: the table is created on demand and it is never deleted, since names may be created
+   before \c initialize_name and deleted after \c finalize_name (e.g., thread local caches). */
+static name_table & get_name_table() {
+    static name_table * g_name_table = new name_table();
+    return *g_name_table;
+}
+
+/** \brief Return an interned object with the given prefix and hash code satisfying \c eq.
+    If there is none, then create one using \c mk, and store it in the table.
+    The reference counter of the result is incremented. */
+template<typename Eq, typename Mk>
+static name::imp * intern_name(name::imp * prefix, unsigned h, Eq const & eq, Mk const & mk) {
+    name_table::shard & s = get_name_table().get_shard(h);
+    lock_guard<mutex> lock(s.m_mutex);
+    auto range = s.m_entries.equal_range(h);
+    for (auto it = range.first; it != range.second; ++it) {
+        name::imp * i = it->second;
+        if (i->m_prefix == prefix && eq(i) && i->try_inc_ref())
+            return i;
+    }
+    name::imp * r = mk();
+    s.m_entries.insert(mk_pair(h, r));
+    return r;
+}
+
+static void erase_interned_name(name::imp * i) {
+    name_table::shard & s = get_name_table().get_shard(i->m_hash);
+    lock_guard<mutex> lock(s.m_mutex);
+    auto range = s.m_entries.equal_range(i->m_hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == i) {
+            s.m_entries.erase(it);
+            return;
+        }
+    }
+}
+
 void name::imp::dealloc() {
     imp * curr = this;
     while (true) {
         lean_assert(curr->get_rc() == 0);
+        erase_interned_name(curr);
         imp * p = curr->m_prefix;
         if (curr->m_is_string)
             delete[] reinterpret_cast<char*>(curr);
@@ -81,23 +147,29 @@ name::name() {
 name::name(name const & prefix, char const * name) {
     size_t sz  = strlen(name);
     lean_assert(sz < (1u << 31));
-    char * mem = new char[sizeof(imp) + sz + 1];
-    m_ptr      = new (mem) imp(true, prefix.m_ptr);
-    std::memcpy(mem + sizeof(imp), name, sz + 1);
-    m_ptr->m_str       = mem + sizeof(imp);
-    if (m_ptr->m_prefix)
-        m_ptr->m_hash = hash_str(sz, name, m_ptr->m_prefix->m_hash);
-    else
-        m_ptr->m_hash = hash_str(sz, name, 0);
+    unsigned h = hash_str(sz, name, prefix.m_ptr ? prefix.m_ptr->m_hash : 0);
+    m_ptr = intern_name(prefix.m_ptr, h,
+                        [&](imp * i) { return i->m_is_string && strcmp(i->m_str, name) == 0; },
+                        [&]() {
+                            char * mem = new char[sizeof(imp) + sz + 1];
+                            imp * r    = new (mem) imp(true, prefix.m_ptr);
+                            std::memcpy(mem + sizeof(imp), name, sz + 1);
+                            r->m_str   = mem + sizeof(imp);
+                            r->m_hash  = h;
+                            return r;
+                        });
 }
 
 name::name(name const & prefix, unsigned k, bool) {
-    m_ptr      = new (get_numeric_name_allocator().allocate()) imp(false, prefix.m_ptr);
-    m_ptr->m_k = k;
-    if (m_ptr->m_prefix)
-        m_ptr->m_hash = ::lean::hash(m_ptr->m_prefix->m_hash, k);
-    else
-        m_ptr->m_hash = k;
+    unsigned h = prefix.m_ptr ? ::lean::hash(prefix.m_ptr->m_hash, k) : k;
+    m_ptr = intern_name(prefix.m_ptr, h,
+                        [&](imp * i) { return !i->m_is_string && i->m_k == k; },
+                        [&]() {
+                            imp * r   = new (get_numeric_name_allocator().allocate()) imp(false, prefix.m_ptr);
+                            r->m_k    = k;
+                            r->m_hash = h;
+                            return r;
+                        });
 }
 
 name::name(name const & prefix, unsigned k):name(prefix, k, true) {
@@ -147,62 +219,19 @@ name_kind name::kind() const {
         return m_ptr->m_is_string ? name_kind::STRING : name_kind::NUMERAL;
 }
 
-/* Equality test core procedure, it is invoked by operator== */
-bool eq_core(name::imp * i1, name::imp * i2) {
-    while (true) {
-        lean_assert(i1 != nullptr);
-        lean_assert(i2 != nullptr);
-        lean_assert(i1 && i2);
-        lean_assert(i1->m_hash == i2->m_hash);
-        if (i1->m_is_string != i2->m_is_string)
-            return false;
-        if (i1->m_is_string) {
-            if (strcmp(i1->m_str, i2->m_str) != 0)
-                return false;
-        } else {
-            if (i1->m_k != i2->m_k)
-                return false;
-        }
-        i1 = i1->m_prefix;
-        i2 = i2->m_prefix;
-        if (i1 == i2)
-            return true;
-        if ((i1 == nullptr) != (i2 == nullptr))
-            return false;
-        if (i1->m_hash != i2->m_hash)
-            return false;
-    }
-}
-
 bool is_prefix_of(name const & n1, name const & n2) {
     if (n2.is_atomic())
         return n1 == n2;
-    buffer<name::imp*> limbs1, limbs2;
-    name::imp* i1 = n1.m_ptr;
-    name::imp* i2 = n2.m_ptr;
-    copy_limbs(i1, limbs1);
-    copy_limbs(i2, limbs2);
-    unsigned sz1 = limbs1.size();
-    unsigned sz2 = limbs2.size();
-    if (sz1 > sz2)
-        return false;
-    else if (sz1 == sz2 && n1.hash() != n2.hash())
-        return false;
-    auto it1 = limbs1.begin();
-    auto it2 = limbs2.begin();
-    for (; it1 != limbs1.end(); ++it1, ++it2) {
-        i1 = *it1;
-        i2 = *it2;
-        if (i1->m_is_string != i2->m_is_string)
-            return false;
-        if (i1->m_is_string) {
-            if (strcmp(i1->m_str, i2->m_str) != 0)
-                return false;
-        } else if (i1->m_k != i2->m_k) {
-            return false;
-        }
+    if (n1.is_anonymous())
+        return true;
+    // names are interned, so n1 is a prefix of n2 iff it occurs in the prefix chain of n2.
+    name::imp * i = n2.m_ptr;
+    while (i != nullptr) {
+        if (i == n1.m_ptr)
+            return true;
+        i = i->m_prefix;
     }
-    return true;
+    return false;
 }
 
 bool operator==(name const & a, char const * b) {
@@ -210,6 +239,8 @@ bool operator==(name const & a, char const * b) {
 }
 
 int cmp(name::imp * i1, name::imp * i2) {
+    if (i1 == i2)
+        return 0;
     buffer<name::imp *> limbs1, limbs2;
     copy_limbs(i1, limbs1);
     copy_limbs(i2, limbs2);
@@ -218,6 +249,8 @@ int cmp(name::imp * i1, name::imp * i2) {
     for (; it1 != limbs1.end() && it2 != limbs2.end(); ++it1, ++it2) {
         i1 = *it1;
         i2 = *it2;
+        if (i1 == i2)
+            continue; // names are interned, so the common prefixes are shared
 
         if (i1->m_is_string != i2->m_is_string)
             return i1->m_is_string ? 1 : -1;
@@ -395,8 +428,8 @@ name_ll_kind ll_kind(name const & n) {
         return n.is_string() ? LL_STRING_PREFIX : LL_INT_PREFIX;
 }
 
-class name_serializer : public object_serializer<name, name::ptr_hash, name::ptr_eq> {
-    typedef object_serializer<name, name::ptr_hash, name::ptr_eq> super;
+class name_serializer : public object_serializer<name, name_hash, name_eq> {
+    typedef object_serializer<name, name_hash, name_eq> super;
 public:
     void write(name const & n) {
         name_ll_kind k = ll_kind(n);
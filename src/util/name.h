@@ -21,6 +21,11 @@ constexpr char const * lean_name_separator = ".";
 enum class name_kind { ANONYMOUS, STRING, NUMERAL };
 /**
    \brief Hierarchical names.
+
+   Names are hash-consed: all names are stored in a global (thread-safe) intern table,
+   and two names are equal iff they are represented by the same \c imp object.
+   So, equality and hashing are pointer operations, and names with a common prefix
+   share the \c imp objects for the prefix.
 */
 class name {
 public:
@@ -36,6 +41,9 @@ public:
         };
         void dealloc();
         imp(bool s, imp * p):m_rc(1), m_is_string(s), m_hash(0), m_prefix(p) { if (p) p->inc_ref(); }
+        /** \brief Increment the reference counter unless it is zero (i.e., the object is being deleted).
+            Return true if the counter was incremented. */
+        bool try_inc_ref();
         static void display_core(std::ostream & out, imp * p, char const * sep);
         static void display(std::ostream & out, imp * p, char const * sep = lean_name_separator);
         friend void copy_limbs(imp * p, buffer<name::imp *> & limbs);
@@ -84,16 +92,8 @@ public:
     name & operator=(name && other);
     /** \brief Return true iff \c n1 is a prefix of \c n2. */
     friend bool is_prefix_of(name const & n1, name const & n2);
-    friend bool eq_core(name::imp * i1, name::imp * i2);
-    friend bool operator==(name const & a, name const & b) {
-        if (a.m_ptr == b.m_ptr)
-            return true;
-        if ((a.m_ptr == nullptr) != (b.m_ptr == nullptr))
-            return false;
-        if (a.m_ptr->m_hash != b.m_ptr->m_hash)
-            return false;
-        return eq_core(a.m_ptr, b.m_ptr);
-    }
+    /** \brief Names are interned. So, structural equality is pointer equality. */
+    friend bool operator==(name const & a, name const & b) { return a.m_ptr == b.m_ptr; }
     friend bool operator!=(name const & a, name const & b) { return !(a == b); }
     friend bool operator==(name const & a, char const * b);
     friend bool operator!=(name const & a, char const * b) { return !(a == b); }
@@ -174,13 +174,10 @@ public:
             return 0;
         unsigned h1 = a.hash();
         unsigned h2 = b.hash();
-        if (h1 != h2) {
+        if (h1 != h2)
             return h1 < h2 ? -1 : 1;
-        } else if (a == b) {
-            return 0;
-        } else {
+        else
             return cmp(a, b);
-        }
     }
 
     struct ptr_hash { unsigned operator()(name const & n) const { return std::hash<imp*>()(n.m_ptr); } };
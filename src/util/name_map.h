@@ -5,10 +5,12 @@ Released under Apache 2.0 license as described in the file LICENSE.
 Author: Leonardo de Moura
 */
 #pragma once
-#include "util/rb_map.h"
+#include "util/hamt_map.h"
 #include "util/name.h"
 namespace lean {
-template<typename T> using name_map = rb_map<name, T, name_quick_cmp>;
+/** \brief Persistent map from names to values. It is implemented using a hash array mapped trie,
+    and its traversal order is the one of <tt>rb_map<name, T, name_quick_cmp></tt>. */
+template<typename T> using name_map = hamt_map<name, T, name_hash, name_quick_cmp>;
 
 class rename_map : public name_map<name> {
 public:
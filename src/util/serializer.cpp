@@ -9,6 +9,8 @@ Author: Leonardo de Moura
 #include <limits>
 #include <stdio.h>
 #include <ios>
+#include <algorithm>
+#include <utility>
 #include "util/serializer.h"
 #include "util/exception.h"
 
@@ -23,23 +25,26 @@ void finalize_serializer() {
     serializer::finalize();
 }
 
-void serializer_core::write_unsigned(unsigned i) {
-    static_assert(sizeof(i) == 4, "unexpected unsigned size");
-    if (i < 255) {
-        m_out.put(i & 0xff);
+void serializer_core::write_string(std::string const & str) {
+    // 0 is followed by a new NUL-terminated string, i+1 is a reference to the i-th string
+    auto it = m_strings.find(str);
+    if (it == m_strings.end()) {
+        write_unsigned(0);
+        m_out.write(str.c_str(), str.size() + 1);
+        unsigned idx = m_strings.size();
+        m_strings.insert(std::make_pair(str, idx));
     } else {
-        m_out.put(0xff);
-        m_out.put((i >> 24) & 0xff);
-        m_out.put((i >> 16) & 0xff);
-        m_out.put((i >> 8) & 0xff);
-        m_out.put(i & 0xff);
+        write_unsigned(it->second + 1);
     }
 }
 
 void serializer_core::write_uint64(uint64 i) {
     static_assert(sizeof(i) == 8, "unexpected uint64 size");
-    write_unsigned((i >> 32) & 0xffffffff);
-    write_unsigned(i & 0xffffffff);
+    while (i >= 0x80) {
+        m_out.put(static_cast<char>((i & 0x7f) | 0x80));
+        i >>= 7;
+    }
+    m_out.put(static_cast<char>(i));
 }
 
 void serializer_core::write_int(int i) {
@@ -64,34 +69,55 @@ void serializer_core::write_double(double d) {
 }
 
 std::string deserializer_core::read_string() {
+    unsigned idx = read_unsigned();
+    if (idx > 0) {
+        if (idx > m_strings.size())
+            throw corrupted_stream_exception();
+        return m_strings[idx - 1];
+    }
     std::string r;
     while (true) {
-        char c = m_in.get();
+        int c = get();
         if (c == 0)
             break;
         if (c == EOF)
             throw corrupted_stream_exception();
-        r += c;
+        r += static_cast<char>(c);
     }
+    m_strings.push_back(r);
     return r;
 }
 
-unsigned deserializer_core::read_unsigned_ext() {
-    unsigned r;
+unsigned deserializer_core::read_unsigned_ext(int c) {
+    if (c == EOF)
+        throw corrupted_stream_exception();
+    unsigned r     = c & 0x7f;
     static_assert(sizeof(r) == 4, "unexpected unsigned size");
-    r  = static_cast<unsigned>(m_in.get()) << 24;
-    r |= static_cast<unsigned>(m_in.get()) << 16;
-    r |= static_cast<unsigned>(m_in.get()) << 8;
-    r |= static_cast<unsigned>(m_in.get());
-    return r;
+    unsigned shift = 7;
+    while (true) {
+        c = get();
+        if (c == EOF || shift > 28)
+            throw corrupted_stream_exception();
+        r |= static_cast<unsigned>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return r;
+        shift += 7;
+    }
 }
 
 uint64 deserializer_core::read_uint64() {
-    uint64 r;
+    uint64 r       = 0;
     static_assert(sizeof(r) == 8, "unexpected uint64 size");
-    r  = static_cast<uint64>(read_unsigned()) << 32;
-    r |= static_cast<uint64>(read_unsigned());
-    return r;
+    unsigned shift = 0;
+    while (true) {
+        int c = get();
+        if (c == EOF || shift > 63)
+            throw corrupted_stream_exception();
+        r |= static_cast<uint64>(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return r;
+        shift += 7;
+    }
 }
 
 double deserializer_core::read_double() {
@@ -104,6 +130,13 @@ double deserializer_core::read_double() {
 
 void deserializer_core::read(std::vector<char> & data) {
     unsigned sz = data.size();
-    m_in.read(data.data(), sz);
+    if (m_in) {
+        m_in->read(data.data(), sz);
+    } else {
+        if (static_cast<size_t>(m_end - m_it) < sz)
+            throw corrupted_stream_exception();
+        std::copy(m_it, m_it + sz, data.data());
+        m_it += sz;
+    }
 }
 }
@@ -6,6 +6,7 @@ Author: Leonardo de Moura
 */
 #pragma once
 #include <vector>
+#include <unordered_map>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -20,14 +21,24 @@ namespace lean {
 /**
    \brief Low-tech serializer.
    The actual functionality is implemented using extensions.
+
+   Unsigned integers are encoded using LEB128 varints, and strings are stored in a
+   per-serializer table, i.e., repeated strings are written as a reference to the first occurrence.
 */
 class serializer_core {
-    std::ostream & m_out;
+    std::ostream &                            m_out;
+    std::unordered_map<std::string, unsigned> m_strings;
 public:
     serializer_core(std::ostream & out):m_out(out) {}
-    void write_string(char const * str) { m_out.write(str, strlen(str) + 1); }
-    void write_string(std::string const & str) { m_out.write(str.c_str(), str.size() + 1); }
-    void write_unsigned(unsigned i);
+    void write_string(char const * str) { write_string(std::string(str)); }
+    void write_string(std::string const & str);
+    void write_unsigned(unsigned i) {
+        while (i >= 0x80) {
+            m_out.put(static_cast<char>((i & 0x7f) | 0x80));
+            i >>= 7;
+        }
+        m_out.put(static_cast<char>(i));
+    }
     void write_uint64(uint64 i);
     void write_int(int i);
     void write_char(char c) { m_out.put(c); }
@@ -47,23 +58,37 @@ inline serializer & operator<<(serializer & s, bool b) { s.write_bool(b); return
 inline serializer & operator<<(serializer & s, double b) { s.write_double(b); return s; }
 
 /**
-   \brief Low-tech serializer.
+   \brief Low-tech deserializer.
    The actual functionality is implemented using extensions.
+
+   The input is either a stream or a memory buffer. The latter avoids the
+   per-byte overhead of \c std::istream::get.
 */
 class deserializer_core {
-    std::istream & m_in;
-    unsigned read_unsigned_ext();
+    std::istream *           m_in;
+    char const *             m_it;
+    char const *             m_end;
+    std::vector<std::string> m_strings;
+    int get() {
+        if (m_in)
+            return m_in->get();
+        else
+            return m_it != m_end ? static_cast<unsigned char>(*(m_it++)) : EOF;
+    }
+    unsigned read_unsigned_ext(int c);
 public:
-    deserializer_core(std::istream & in):m_in(in) {}
+    deserializer_core(std::istream & in):m_in(&in), m_it(nullptr), m_end(nullptr) {}
+    /** \brief Read from the memory buffer [begin, end). The buffer must outlive the deserializer. */
+    deserializer_core(char const * begin, char const * end):m_in(nullptr), m_it(begin), m_end(end) {}
     std::string read_string();
     unsigned read_unsigned() {
-        unsigned r = static_cast<unsigned>(m_in.get());
-        return r < 255 ? r : read_unsigned_ext();
+        int c = get();
+        return (c >= 0 && c < 0x80) ? static_cast<unsigned>(c) : read_unsigned_ext(c);
     }
     uint64 read_uint64();
     int read_int() { return read_unsigned(); }
-    char read_char() { return m_in.get(); }
-    bool read_bool() { return m_in.get() != 0; }
+    char read_char() { return get(); }
+    bool read_bool() { return get() != 0; }
     double read_double();
     // read data.size() bytes from input stream and store it at data
     void read(std::vector<char> & data);
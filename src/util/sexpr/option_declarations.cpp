@@ -4,6 +4,8 @@ Released under Apache 2.0 license as described in the file LICENSE.
 
 Author: Leonardo de Moura
 */
+#include <unordered_map>
+#include <vector>
 #include "util/sexpr/option_declarations.h"
 #include "util/sexpr/format.h"
 
@@ -53,12 +55,21 @@ void option_declaration::display_value(std::ostream & out, options const & o) co
 }
 
 static option_declarations * g_option_declarations = nullptr;
+/* Mapping from option name to slot, and from slot to option name.
+   Remark: options are only registered during initialization. */
+typedef std::unordered_map<name, unsigned, name_hash, name_eq> option_slot_map;
+static option_slot_map *   g_option_slots = nullptr;
+static std::vector<name> * g_option_names = nullptr;
 
 void initialize_option_declarations() {
     g_option_declarations = new option_declarations();
+    g_option_slots        = new option_slot_map();
+    g_option_names        = new std::vector<name>();
 }
 
 void finalize_option_declarations() {
+    delete g_option_names;
+    delete g_option_slots;
     delete g_option_declarations;
 }
 
@@ -66,7 +77,33 @@ option_declarations const & get_option_declarations() {
     return *g_option_declarations;
 }
 
-void register_option(name const & n, option_kind k, char const * default_value, char const * description) {
-    g_option_declarations->insert(mk_pair(n, option_declaration(n, k, default_value, description)));
+optional<option_slot> get_option_slot(name const & n) {
+    if (!g_option_slots)
+        return optional<option_slot>();
+    auto it = g_option_slots->find(n);
+    if (it == g_option_slots->end())
+        return optional<option_slot>();
+    else
+        return optional<option_slot>(option_slot(it->second));
+}
+
+name const & get_option_slot_name(option_slot s) {
+    lean_assert(s.get_idx() < g_option_names->size());
+    return (*g_option_names)[s.get_idx()];
+}
+
+unsigned get_num_option_declarations() {
+    return g_option_names ? g_option_names->size() : 0;
+}
+
+option_slot register_option(name const & n, option_kind k, char const * default_value, char const * description) {
+    auto it = g_option_declarations->find(n);
+    if (it != g_option_declarations->end())
+        return it->second.get_slot();
+    option_slot s(g_option_names->size());
+    g_option_declarations->insert(mk_pair(n, option_declaration(n, k, default_value, description, s)));
+    g_option_slots->insert(mk_pair(n, s.get_idx()));
+    g_option_names->push_back(n);
+    return s;
 }
 }
@@ -8,6 +8,7 @@ Author: Leonardo de Moura
 #include <map>
 #include <string>
 #include "util/macros.h"
+#include "util/optional.h"
 #include "util/sexpr/options.h"
 
 namespace lean {
@@ -20,10 +21,12 @@ class option_declaration {
     option_kind m_kind;
     std::string m_default;
     std::string m_description;
+    option_slot m_slot;
 public:
-    option_declaration(name const & n, option_kind k, char const * default_val, char const * descr):
-        m_name(n), m_kind(k), m_default(default_val), m_description(descr) {}
+    option_declaration(name const & n, option_kind k, char const * default_val, char const * descr, option_slot s):
+        m_name(n), m_kind(k), m_default(default_val), m_description(descr), m_slot(s) {}
     option_kind kind() const { return m_kind; }
+    option_slot get_slot() const { return m_slot; }
     name const & get_name() const { return m_name; }
     std::string const & get_default_value() const { return m_default; }
     std::string const & get_description() const { return m_description; }
@@ -36,7 +39,14 @@ typedef std::map<name, option_declaration> option_declarations;
 void initialize_option_declarations();
 void finalize_option_declarations();
 option_declarations const & get_option_declarations();
-void register_option(name const & n, option_kind k, char const * default_value, char const * description);
+/** \brief Return the slot of the registered option named \c n. */
+optional<option_slot> get_option_slot(name const & n);
+/** \brief Return the name of the registered option with slot \c s. */
+name const & get_option_slot_name(option_slot s);
+unsigned get_num_option_declarations();
+/** \brief Register an option, and return its slot. Registering an option again returns the slot assigned
+    the first time. */
+option_slot register_option(name const & n, option_kind k, char const * default_value, char const * description);
 #define register_bool_option(n, v, d) register_option(n, BoolOption, LEAN_STR(v), d)
 #define register_unsigned_option(n, v, d) register_option(n, UnsignedOption, LEAN_STR(v), d)
 #define register_double_option(n, v, d) register_option(n, DoubleOption, LEAN_STR(v), d)
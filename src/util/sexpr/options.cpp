@@ -6,6 +6,7 @@ Author: Leonardo de Moura
 */
 #include <memory>
 #include <string>
+#include <vector>
 #include "util/sstream.h"
 #include "util/sexpr/options.h"
 #include "util/sexpr/option_declarations.h"
@@ -23,15 +24,20 @@ Author: Leonardo de Moura
 namespace lean {
 static name * g_verbose    = nullptr;
 static name * g_max_memory = nullptr;
+static option_slot * g_verbose_slot    = nullptr;
+static option_slot * g_max_memory_slot = nullptr;
 
 void initialize_options() {
     g_verbose    = new name("verbose");
     g_max_memory = new name("max_memory");
-    register_bool_option(*g_verbose, LEAN_DEFAULT_VERBOSE, "disable/enable verbose messages");
-    register_unsigned_option(*g_max_memory, LEAN_DEFAULT_MAX_MEMORY, "maximum amount of memory available for Lean in megabytes");
+    g_verbose_slot    = new option_slot(register_bool_option(*g_verbose, LEAN_DEFAULT_VERBOSE, "disable/enable verbose messages"));
+    g_max_memory_slot = new option_slot(register_unsigned_option(*g_max_memory, LEAN_DEFAULT_MAX_MEMORY,
+                                                                 "maximum amount of memory available for Lean in megabytes"));
 }
 
 void finalize_options() {
+    delete g_verbose_slot;
+    delete g_max_memory_slot;
     delete g_verbose;
     delete g_max_memory;
 }
@@ -45,11 +51,11 @@ name const & get_max_memory_opt_name() {
 }
 
 bool get_verbose(options const & opts) {
-    return opts.get_bool(*g_verbose, LEAN_DEFAULT_VERBOSE);
+    return opts.get_bool(*g_verbose_slot, LEAN_DEFAULT_VERBOSE);
 }
 
 unsigned get_max_memory(options const & opts) {
-    return opts.get_unsigned(*g_max_memory, LEAN_DEFAULT_MAX_MEMORY);
+    return opts.get_unsigned(*g_max_memory_slot, LEAN_DEFAULT_MAX_MEMORY);
 }
 
 std::ostream & operator<<(std::ostream & out, option_kind k) {
@@ -64,6 +70,48 @@ std::ostream & operator<<(std::ostream & out, option_kind k) {
     return out;
 }
 
+options::options(sexpr const & v):m_value(v) {
+    if (is_nil(m_value))
+        return;
+    auto slots = std::make_shared<slot_table>(get_num_option_declarations());
+    for (sexpr const * it = &m_value; !is_nil(*it); it = &cdr(*it)) {
+        sexpr const & p = car(*it);
+        if (optional<option_slot> s = get_option_slot(to_name(head(p)))) {
+            unsigned idx = s->get_idx();
+            if (idx >= slots->m_entries.size())
+                slots->m_entries.resize(idx + 1);
+            // the first entry is the one a linear search would find
+            if (is_nil(slots->m_entries[idx]))
+                slots->m_entries[idx] = p;
+        }
+    }
+    m_slots = slots;
+}
+
+/** \brief Return the entry (pair (name, value)) for the option with slot \c s, or nullptr if it is not set. */
+sexpr const * options::find_entry(option_slot s) const {
+    if (!m_slots)
+        return nullptr;
+    unsigned idx = s.get_idx();
+    if (idx < m_slots->m_num_slots) {
+        if (idx < m_slots->m_entries.size() && !is_nil(m_slots->m_entries[idx]))
+            return &m_slots->m_entries[idx];
+        return nullptr;
+    }
+    // option was registered after the slot table was created
+    name const & n = get_option_slot_name(s);
+    return find(m_value, [&](sexpr const & p) { return to_name(head(p)) == n; });
+}
+
+/** \brief Return the entry (pair (name, value)) for \c n, or nullptr if \c n is not set. */
+sexpr const * options::find_entry(name const & n) const {
+    if (!m_slots)
+        return nullptr;
+    if (optional<option_slot> s = get_option_slot(n))
+        return find_entry(*s);
+    return find(m_value, [&](sexpr const & p) { return to_name(head(p)) == n; });
+}
+
 bool options::empty() const {
     return is_nil(m_value);
 }
@@ -73,7 +121,7 @@ unsigned options::size() const {
 }
 
 bool options::contains(name const & n) const {
-    return ::lean::contains(m_value, [&](sexpr const & p) { return to_name(head(p)) == n; });
+    return find_entry(n) != nullptr;
 }
 
 bool options::contains(char const * n) const {
@@ -81,7 +129,7 @@ bool options::contains(char const * n) const {
 }
 
 sexpr options::get_sexpr(name const & n, sexpr const & default_value) const {
-    sexpr const * r = find(m_value, [&](sexpr const & p) { return to_name(head(p)) == n; });
+    sexpr const * r = find_entry(n);
     return r == nullptr ? default_value : tail(*r);
 }
 
@@ -140,22 +188,68 @@ char const * options::get_string(char const * n, char const * default_value) con
     return !is_nil(r) && is_string(r) ? to_string(r).c_str() : default_value;
 }
 
+sexpr options::get_sexpr(option_slot s, sexpr const & default_value) const {
+    sexpr const * r = find_entry(s);
+    return r == nullptr ? default_value : tail(*r);
+}
+
+int options::get_int(option_slot s, int default_value) const {
+    sexpr const * r = find_entry(s);
+    return r != nullptr && is_int(tail(*r)) ? to_int(tail(*r)) : default_value;
+}
+
+unsigned options::get_unsigned(option_slot s, unsigned default_value) const {
+    sexpr const * r = find_entry(s);
+    return r != nullptr && is_int(tail(*r)) ? static_cast<unsigned>(to_int(tail(*r))) : default_value;
+}
+
+bool options::get_bool(option_slot s, bool default_value) const {
+    sexpr const * r = find_entry(s);
+    return r != nullptr && is_bool(tail(*r)) ? to_bool(tail(*r)) != 0 : default_value;
+}
+
+double options::get_double(option_slot s, double default_value) const {
+    sexpr const * r = find_entry(s);
+    return r != nullptr && is_double(tail(*r)) ? to_double(tail(*r)) : default_value;
+}
+
+char const * options::get_string(option_slot s, char const * default_value) const {
+    sexpr const * r = find_entry(s);
+    return r != nullptr && is_string(tail(*r)) ? to_string(tail(*r)).c_str() : default_value;
+}
+
 static char const * g_left_angle_bracket  = "\u27E8";
 static char const * g_right_angle_bracket = "\u27E9";
 static char const * g_arrow               = "\u21a6";
 static char const * g_assign              = ":=";
 
 options options::update(name const & n, sexpr const & v) const {
-    if (contains(n)) {
-        return map(m_value, [&](sexpr p) {
-                if (to_name(car(p)) == n)
-                    return cons(car(p), v);
-                else
+    optional<option_slot> s = get_option_slot(n);
+    sexpr new_entry;
+    sexpr new_value;
+    if ((s ? find_entry(*s) : find_entry(n)) != nullptr) {
+        new_value = map(m_value, [&](sexpr p) {
+                if (to_name(car(p)) == n) {
+                    new_entry = cons(car(p), v);
+                    return new_entry;
+                } else {
                     return p;
+                }
             });
     } else {
-        return options(cons(cons(sexpr(n), v), m_value));
+        new_entry = cons(sexpr(n), v);
+        new_value = cons(new_entry, m_value);
+    }
+    if (m_slots && !s)
+        return options(new_value, m_slots);
+    auto slots = m_slots ? std::make_shared<slot_table>(*m_slots) : std::make_shared<slot_table>(get_num_option_declarations());
+    if (s && s->get_idx() < slots->m_num_slots) {
+        unsigned idx = s->get_idx();
+        if (idx >= slots->m_entries.size())
+            slots->m_entries.resize(idx + 1);
+        slots->m_entries[idx] = new_entry;
     }
+    return options(new_value, slots);
 }
 
 options join(options const & opts1, options const & opts2) {
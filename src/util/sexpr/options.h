@@ -6,6 +6,8 @@ Author: Leonardo de Moura
 */
 #pragma once
 #include <algorithm>
+#include <memory>
+#include <vector>
 #include "util/name.h"
 #include "util/sexpr/sexpr.h"
 #include "util/sexpr/format.h"
@@ -15,18 +17,42 @@ namespace lean {
 enum option_kind { BoolOption, IntOption, UnsignedOption, DoubleOption, StringOption, SExprOption };
 std::ostream & operator<<(std::ostream & out, option_kind k);
 
+/** \brief Dense index assigned to an option when it is registered (see \c register_option).
+    Options can be read using their slots without any name lookup. */
+class option_slot {
+    unsigned m_idx;
+public:
+    explicit option_slot(unsigned idx):m_idx(idx) {}
+    unsigned get_idx() const { return m_idx; }
+};
+
 /** \brief Configuration options. */
 class options {
-    sexpr m_value;
-    options(sexpr const & v):m_value(v) {}
+    /** \brief Entries (pairs (name, value)) of \c m_value that are registered options indexed by their slots.
+        The table is copied and updated by #update, i.e., it is never rebuilt from \c m_value. */
+    struct slot_table {
+        /* Number of registered options when the table was created.
+           The entries of options registered later are not in the table. */
+        unsigned           m_num_slots;
+        std::vector<sexpr> m_entries;
+        slot_table(unsigned num_slots):m_num_slots(num_slots) {}
+    };
+    typedef std::shared_ptr<slot_table const> slot_table_ptr;
+    sexpr          m_value;
+    slot_table_ptr m_slots; // nullptr iff m_value is empty
+    options(sexpr const & v);
+    options(sexpr const & v, slot_table_ptr const & s):m_value(v), m_slots(s) {}
+    sexpr const * find_entry(name const & n) const;
+    sexpr const * find_entry(option_slot s) const;
 public:
     options() {}
-    options(options const & o):m_value(o.m_value) {}
-    options(options && o):m_value(std::move(o.m_value)) {}
+    options(options const & o):m_value(o.m_value), m_slots(o.m_slots) {}
+    options(options && o):m_value(std::move(o.m_value)), m_slots(std::move(o.m_slots)) {}
     template<typename T> options(name const & n, T const & t) { *this = update(n, t); }
     ~options() {}
 
-    options & operator=(options const & o) { m_value = o.m_value; return *this; }
+    options & operator=(options const & o) { m_value = o.m_value; m_slots = o.m_slots; return *this; }
+    options & operator=(options && o) { m_value = std::move(o.m_value); m_slots = std::move(o.m_slots); return *this; }
 
     bool empty() const;
     unsigned size() const;
@@ -48,6 +74,13 @@ public:
     char const * get_string(char const * n, char const * default_value = nullptr) const;
     sexpr        get_sexpr(char const * n, sexpr const & default_value = sexpr()) const;
 
+    bool         get_bool(option_slot s, bool default_value = false) const;
+    int          get_int(option_slot s, int default_value = 0) const;
+    unsigned     get_unsigned(option_slot s, unsigned default_value = 0) const;
+    double       get_double(option_slot s, double default_value = 0.0) const;
+    char const * get_string(option_slot s, char const * default_value = nullptr) const;
+    sexpr        get_sexpr(option_slot s, sexpr const & default_value = sexpr()) const;
+
     void for_each(std::function<void(name const &)> const & fn) const;
 
     options update(name const & n, sexpr const & v) const;
@@ -0,0 +1,99 @@
+/*
+Copyright (c) 2015 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <string>
+#include "util/sha256.h"
+
+namespace lean {
+static unsigned const g_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline unsigned rotr(unsigned x, unsigned n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+sha256::sha256():m_block_size(0), m_length(0) {
+    m_state[0] = 0x6a09e667; m_state[1] = 0xbb67ae85; m_state[2] = 0x3c6ef372; m_state[3] = 0xa54ff53a;
+    m_state[4] = 0x510e527f; m_state[5] = 0x9b05688c; m_state[6] = 0x1f83d9ab; m_state[7] = 0x5be0cd19;
+}
+
+void sha256::process_block() {
+    unsigned w[64];
+    for (unsigned i = 0; i < 16; i++) {
+        w[i] = (static_cast<unsigned>(m_block[4*i]) << 24) | (static_cast<unsigned>(m_block[4*i+1]) << 16) |
+            (static_cast<unsigned>(m_block[4*i+2]) << 8) | static_cast<unsigned>(m_block[4*i+3]);
+    }
+    for (unsigned i = 16; i < 64; i++) {
+        unsigned s0 = rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+        unsigned s1 = rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+    unsigned a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3];
+    unsigned e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+    for (unsigned i = 0; i < 64; i++) {
+        unsigned t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + g_k[i] + w[i];
+        unsigned t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    m_state[0] += a; m_state[1] += b; m_state[2] += c; m_state[3] += d;
+    m_state[4] += e; m_state[5] += f; m_state[6] += g; m_state[7] += h;
+    m_block_size = 0;
+}
+
+void sha256::update(void const * data, unsigned size) {
+    unsigned char const * it = static_cast<unsigned char const *>(data);
+    m_length += size;
+    for (unsigned i = 0; i < size; i++) {
+        m_block[m_block_size++] = it[i];
+        if (m_block_size == 64)
+            process_block();
+    }
+}
+
+std::string sha256::digest() {
+    uint64 bit_length = m_length * 8;
+    m_block[m_block_size++] = 0x80;
+    if (m_block_size > 56) {
+        while (m_block_size < 64)
+            m_block[m_block_size++] = 0;
+        process_block();
+    }
+    while (m_block_size < 56)
+        m_block[m_block_size++] = 0;
+    for (unsigned i = 0; i < 8; i++)
+        m_block[56 + i] = static_cast<unsigned char>(bit_length >> (8 * (7 - i)));
+    process_block();
+    std::string r(32, '\0');
+    for (unsigned i = 0; i < 8; i++) {
+        r[4*i]   = static_cast<char>(m_state[i] >> 24);
+        r[4*i+1] = static_cast<char>(m_state[i] >> 16);
+        r[4*i+2] = static_cast<char>(m_state[i] >> 8);
+        r[4*i+3] = static_cast<char>(m_state[i]);
+    }
+    return r;
+}
+
+std::string to_hex(std::string const & s) {
+    static char const digits[] = "0123456789abcdef";
+    std::string r;
+    r.reserve(2 * s.size());
+    for (char c : s) {
+        unsigned char u = static_cast<unsigned char>(c);
+        r += digits[u >> 4];
+        r += digits[u & 0xf];
+    }
+    return r;
+}
+}
@@ -0,0 +1,29 @@
+/*
+Copyright (c) 2015 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include <string>
+#include "util/int64.h"
+
+namespace lean {
+/** \brief Incremental SHA-256 (FIPS 180-4). */
+class sha256 {
+    unsigned      m_state[8];
+    unsigned char m_block[64];
+    unsigned      m_block_size;
+    uint64        m_length; // number of bytes processed so far
+    void process_block();
+public:
+    sha256();
+    void update(void const * data, unsigned size);
+    void update(std::string const & s) { update(s.data(), s.size()); }
+    /** \brief Return the 32 bytes of the digest. The object must not be updated afterwards. */
+    std::string digest();
+};
+
+/** \brief Return the lowercase hexadecimal representation of \c s */
+std::string to_hex(std::string const & s);
+}
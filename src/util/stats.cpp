@@ -0,0 +1,223 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "util/exception.h"
+#include "util/sstream.h"
+#include "util/stats.h"
+
+#ifndef LEAN_MAX_STATS_CELLS
+#define LEAN_MAX_STATS_CELLS 2048
+#endif
+
+namespace lean {
+struct stats_decl {
+    name        m_name;
+    std::string m_description;
+    stats_id    m_id;
+    bool        m_histogram;
+    stats_decl(name const & n, char const * d, stats_id id, bool h):m_name(n), m_description(d), m_id(id), m_histogram(h) {}
+    unsigned size() const { return m_histogram ? LEAN_STATS_HISTOGRAM_SIZE : 1; }
+};
+
+/* Remark: blocks are allocated with LEAN_MAX_STATS_CELLS cells. So, registering new counters
+   does not require us to resize the blocks owned by running threads. */
+struct stats_block {
+    stats_cell * m_cells;
+    stats_block();
+    ~stats_block();
+};
+
+typedef std::unordered_map<name, stats_values, name_hash, name_eq> stats_groups;
+
+static std::vector<stats_decl> * g_stats_decls  = nullptr;
+static unsigned                  g_num_cells    = 0;
+static mutex *                   g_stats_mutex  = nullptr;
+/* blocks owned by running threads */
+static std::vector<stats_block*> * g_stats_blocks = nullptr;
+/* values produced by threads that have been finalized */
+static stats_values *            g_stats_retired = nullptr;
+static stats_groups *            g_stats_groups  = nullptr;
+
+stats_block::stats_block() {
+    m_cells = new stats_cell[LEAN_MAX_STATS_CELLS];
+    for (unsigned i = 0; i < LEAN_MAX_STATS_CELLS; i++)
+        m_cells[i].store(0);
+    if (g_stats_mutex) {
+        lock_guard<mutex> lock(*g_stats_mutex);
+        g_stats_blocks->push_back(this);
+    }
+}
+
+stats_block::~stats_block() {
+    if (g_stats_mutex) {
+        lock_guard<mutex> lock(*g_stats_mutex);
+        for (unsigned i = 0; i < g_num_cells; i++)
+            (*g_stats_retired)[i] += atomic_load(m_cells + i);
+        auto it = std::find(g_stats_blocks->begin(), g_stats_blocks->end(), this);
+        if (it != g_stats_blocks->end())
+            g_stats_blocks->erase(it);
+    }
+    delete[] m_cells;
+}
+
+MK_THREAD_LOCAL_GET_DEF(stats_block, get_stats_block);
+
+stats_cell * get_thread_stats_block() {
+    return get_stats_block().m_cells;
+}
+
+static stats_id register_stats(name const & n, char const * description, bool histogram) {
+    lock_guard<mutex> lock(*g_stats_mutex);
+    for (stats_decl const & d : *g_stats_decls) {
+        if (d.m_name == n)
+            throw exception(sstream() << "invalid statistics counter declaration, '" << n << "' has already been declared");
+    }
+    stats_id id = g_num_cells;
+    stats_decl d(n, description, id, histogram);
+    if (g_num_cells + d.size() > LEAN_MAX_STATS_CELLS)
+        throw exception("too many statistics counters, recompile Lean using a bigger LEAN_MAX_STATS_CELLS");
+    g_num_cells += d.size();
+    g_stats_decls->push_back(d);
+    g_stats_retired->resize(g_num_cells, 0);
+    return id;
+}
+
+stats_id register_stats_counter(name const & n, char const * description) {
+    return register_stats(n, description, false);
+}
+
+stats_id register_stats_histogram(name const & n, char const * description) {
+    return register_stats(n, description, true);
+}
+
+void stats_record(stats_id id, uint64 v) {
+    unsigned bucket = 0;
+    while (v != 0 && bucket + 1 < LEAN_STATS_HISTOGRAM_SIZE) {
+        v >>= 1;
+        bucket++;
+    }
+    stats_inc(id + bucket);
+}
+
+static void add_block(stats_values & r, stats_cell const * cells) {
+    for (unsigned i = 0; i < r.size(); i++)
+        r[i] += atomic_load(cells + i);
+}
+
+stats_values get_stats() {
+    lock_guard<mutex> lock(*g_stats_mutex);
+    stats_values r(*g_stats_retired);
+    for (stats_block const * b : *g_stats_blocks)
+        add_block(r, b->m_cells);
+    return r;
+}
+
+stats_values get_thread_stats() {
+    stats_values r(g_num_cells, 0);
+    add_block(r, get_thread_stats_block());
+    return r;
+}
+
+void add_group_stats(name const & n, stats_values const & vs) {
+    lock_guard<mutex> lock(*g_stats_mutex);
+    stats_values & r = (*g_stats_groups)[n];
+    r.resize(std::max(r.size(), vs.size()), 0);
+    for (unsigned i = 0; i < vs.size(); i++)
+        r[i] += vs[i];
+}
+
+void clear_group_stats() {
+    lock_guard<mutex> lock(*g_stats_mutex);
+    g_stats_groups->clear();
+}
+
+scope_stats_group::scope_stats_group(name const & n, bool active):
+    m_active(active), m_group(n) {
+    if (m_active)
+        m_start = get_thread_stats();
+}
+
+scope_stats_group::~scope_stats_group() {
+    if (!m_active)
+        return;
+    stats_values vs = get_thread_stats();
+    bool nonzero = false;
+    for (unsigned i = 0; i < m_start.size(); i++) {
+        vs[i] -= m_start[i];
+        if (vs[i] != 0)
+            nonzero = true;
+    }
+    if (nonzero)
+        add_group_stats(m_group, vs);
+}
+
+void display_stats(std::ostream & out, stats_values const & vs) {
+    for (stats_decl const & d : *g_stats_decls) {
+        if (d.m_id + d.size() > vs.size())
+            continue;
+        if (!d.m_histogram) {
+            if (vs[d.m_id] != 0)
+                out << "  " << d.m_name << " " << vs[d.m_id] << "\n";
+        } else {
+            uint64 total = 0;
+            for (unsigned i = 0; i < d.size(); i++)
+                total += vs[d.m_id + i];
+            if (total == 0)
+                continue;
+            out << "  " << d.m_name << " " << total << " [";
+            bool first = true;
+            for (unsigned i = 0; i < d.size(); i++) {
+                if (vs[d.m_id + i] == 0)
+                    continue;
+                if (!first) out << ", ";
+                first = false;
+                out << "<" << (static_cast<uint64>(1) << i) << ": " << vs[d.m_id + i];
+            }
+            out << "]\n";
+        }
+    }
+}
+
+void display_group_stats(std::ostream & out) {
+    std::vector<name> groups;
+    {
+        lock_guard<mutex> lock(*g_stats_mutex);
+        for (auto const & p : *g_stats_groups)
+            groups.push_back(p.first);
+    }
+    std::sort(groups.begin(), groups.end());
+    for (name const & n : groups) {
+        stats_values vs;
+        {
+            lock_guard<mutex> lock(*g_stats_mutex);
+            vs = (*g_stats_groups)[n];
+        }
+        out << n << "\n";
+        display_stats(out, vs);
+    }
+}
+
+void initialize_stats() {
+    g_stats_decls   = new std::vector<stats_decl>();
+    g_stats_mutex   = new mutex();
+    g_stats_blocks  = new std::vector<stats_block*>();
+    g_stats_retired = new stats_values();
+    g_stats_groups  = new stats_groups();
+}
+
+void finalize_stats() {
+    delete g_stats_groups;
+    delete g_stats_retired;
+    delete g_stats_blocks;
+    delete g_stats_mutex;
+    delete g_stats_decls;
+    g_stats_mutex = nullptr;
+}
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (c) 2016 Microsoft Corporation. All rights reserved.
+Released under Apache 2.0 license as described in the file LICENSE.
+
+Author: Leonardo de Moura
+*/
+#pragma once
+#include <iostream>
+#include <vector>
+#include "util/int64.h"
+#include "util/thread.h"
+#include "util/name.h"
+
+#ifndef LEAN_STATS_HISTOGRAM_SIZE
+#define LEAN_STATS_HISTOGRAM_SIZE 32
+#endif
+
+namespace lean {
+/**
+   \brief Statistics counters and histograms.
+
+   They are registered during initialization, and are always enabled.
+   Each thread owns a block of counters, and an update is a single relaxed add in this block.
+   The values produced by all threads are combined by \c get_stats.
+
+   A histogram is a sequence of LEAN_STATS_HISTOGRAM_SIZE counters, the i-th one
+   counts the recorded values v s.t. 2^(i-1) <= v < 2^i.
+*/
+typedef unsigned stats_id;
+typedef atomic<uint64> stats_cell;
+typedef std::vector<uint64> stats_values;
+
+stats_id register_stats_counter(name const & n, char const * description);
+stats_id register_stats_histogram(name const & n, char const * description);
+
+/** \brief Return the block of counters of the current thread. */
+stats_cell * get_thread_stats_block();
+
+inline void stats_inc(stats_id id, uint64 v = 1) {
+    atomic_fetch_add_explicit(get_thread_stats_block() + id, v, memory_order_relaxed);
+}
+
+/** \brief Add the value \c v to the histogram \c id. */
+void stats_record(stats_id id, uint64 v);
+
+/** \brief Return the values of all counters (for all threads). */
+stats_values get_stats();
+/** \brief Return the values of all counters for the current thread. */
+stats_values get_thread_stats();
+
+/**
+   \brief Add the values produced by the current thread while this object is alive
+   to the group \c n (e.g., a declaration name).
+*/
+class scope_stats_group {
+    bool         m_active;
+    name         m_group;
+    stats_values m_start;
+public:
+    scope_stats_group(name const & n, bool active = true);
+    ~scope_stats_group();
+};
+
+/** \brief Add \c vs to the values of the group \c n. */
+void add_group_stats(name const & n, stats_values const & vs);
+/** \brief Remove all groups. */
+void clear_group_stats();
+
+/** \brief Display nonzero values. */
+void display_stats(std::ostream & out, stats_values const & vs);
+/** \brief Display nonzero values for each group. */
+void display_group_stats(std::ostream & out);
+
+void initialize_stats();
+void finalize_stats();
+}
@@ -100,6 +100,10 @@ public:
     operator T() const { return m_value; }
     void store(T const & v) { m_value = v; }
     T load() const { return m_value; }
+    bool compare_exchange_weak(T & expected, T const & v) {
+        if (m_value == expected) { m_value = v; return true; }
+        expected = m_value; return false;
+    }
     atomic & operator|=(T const & v) { m_value |= v; return *this; }
     atomic & operator+=(T const & v) { m_value += v; return *this; }
     atomic & operator-=(T const & v) { m_value -= v; return *this; }
@@ -0,0 +1,9 @@
+set_option compress_proofs true
+theorem add_twenty : (20:nat) + 20 = 40 ∧ (20:nat) + 20 = 40 ∧ (20:nat) + 20 = 40 :=
+and.intro rfl (and.intro rfl rfl)
+theorem add_twenty' (a : nat) (h : a = 20 + 20) : a = 20 + 20 ∧ 20 + 20 = a :=
+and.intro h (eq.symm h)
+example : (20:nat) + 20 = 40 := and.left add_twenty
+reveal add_twenty add_twenty'
+print add_twenty
+print add_twenty'
@@ -0,0 +1,20 @@
+namespace foo
+  definition f (a : nat) : nat := a
+  definition g (a : nat) : nat → nat := λ b, a
+end foo
+
+namespace bla
+  definition f (a : nat) : bool := bool.tt
+  definition g (a : nat) : Type₁ := nat
+end bla
+
+open foo bla
+
+example : nat := f 1
+example : bool := f 1
+example : f 0 = 0 := rfl
+example : f 0 = bool.tt := rfl
+example : nat := g 1 2
+example : Type₁ := g 1
+example (x : g 1) : nat := x
+example : (λ x : nat, f x) 1 = 1 := rfl
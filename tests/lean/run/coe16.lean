@@ -0,0 +1,33 @@
+import data.nat
+open nat
+
+constant list2 : Type₁ → Type₁
+constant vec2  : Type₁ → Type₁
+structure box (X : Type₁) := (val : X)
+
+constant to_list2 {X : Type₁} : box X → list2 X
+constant to_vec2 {X : Type₁} : list2 X → vec2 X
+constant vec2_fun {X : Type₁} : vec2 X → nat → X
+constant size {X : Type₁} : vec2 X → nat
+attribute to_list2 [coercion]
+attribute to_vec2 [coercion]
+attribute vec2_fun [coercion]
+
+constant bx : box nat
+
+-- compositions of coercions are computed on demand, and applied without beta-redexes
+check size bx
+example : size bx = size (to_vec2 (to_list2 bx)) := rfl
+example : bx 0 = vec2_fun (to_vec2 (to_list2 bx)) 0 := rfl
+
+-- compositions declared in a namespace are available when the namespace is opened
+constant vec3 : Type₁ → Type₁
+constant size3 {X : Type₁} : vec3 X → nat
+namespace vec3
+  constant of_vec2 {X : Type₁} : vec2 X → vec3 X
+  attribute of_vec2 [coercion]
+end vec3
+
+open vec3
+check size3 bx
+example : size3 bx = size3 (of_vec2 (to_vec2 (to_list2 bx))) := rfl
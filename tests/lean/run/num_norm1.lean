@@ -158,3 +158,9 @@ example : (- 19 * - - (75 * - - 41)) = (-58425 : A) := by norm_num
 example : ((3 / ((- 28 * 45) * (19 + ((- (- 88 - (- (- 1 + 90) + 8)) + 87) * 48)))) + 1) = (1903019/1903020 : A) := by norm_num
 example : ((- - (28 + 48) / 75) + ((- 59 - 14) - 0)) = (-5399/75 : A) := by norm_num
 example : (- ((- (((66 - 86) - 36) / 94) - 3) / - - (77 / (56 - - - 79))) + 87) = (312254/3619 : A) := by norm_num
+
+-- the smaller numeral is used as multiplier
+example : (3 : A) * 123456789 = 370370367 := by norm_num
+example : (123456789 : A) * 3 = 370370367 := by norm_num
+example : (-3 : A) * 123456789 = -370370367 := by norm_num
+example : (123456789 : A) * 3 + 3 * 123456789 = 740740734 := by norm_num
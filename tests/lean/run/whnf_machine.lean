@@ -0,0 +1,9 @@
+set_option whnf_machine true
+open nat
+
+definition twice (f : nat → nat) (x : nat) : nat := f (f x)
+
+example (x : nat) : (λ f : nat → nat, f x) (λ y, y) = x := rfl
+example (x : nat) : (let y := x, z := (λ w : nat, w) y in z) = x := rfl
+example (x : nat) : twice (λ y, y) x = x := rfl
+example : (let f := λ n : nat, succ n in f (f 0)) = 2 := rfl